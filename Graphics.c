@@ -16,6 +16,10 @@
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/BaseLib.h>
+#include <Library/SynchronizationLib.h>
+#include <Library/TimerLib.h>
+#include <Protocol/MpService.h>
 #include "Graphics.h"
 #include "fonts/fonts.h"
 
@@ -36,21 +40,358 @@
 // When defined uses a different function to draw (full) circles that are not clipped
 #define CIRCLE_OPTIMISATION 1
 
+// When defined large render buffer fills are split into jobs and run on all cores
+#define JOB_SCHEDULER 1
+
 #define DEFAULT_FONT        FONT10x20
 #define DEFAULT_FG_COLOUR   WHITE
 #define DEFAULT_BG_COLOUR   BLACK
 
+// Triangle rasteriser, vertices are fixed point with SUBPIXEL_BITS fraction bits
+#define SUBPIXEL_BITS           4
+#define SUBPIXEL_ONE            (1 << SUBPIXEL_BITS)
+#define SUBPIXEL_HALF           (SUBPIXEL_ONE >> 1)
+#define PIXEL_TO_SUBPIXEL(p)    ((INT64)(p) * SUBPIXEL_ONE + SUBPIXEL_HALF)
+#define RASTER_GUARD_BAND       ((INT64)1 << 26)    // max vertex ord (subpixel), keeps edge functions within 64 bits
+
+// Edge function at pixel [x,y] is E0 + StepX*x + StepY*y
+typedef struct {
+    INT64   StepX;
+    INT64   StepY;
+    INT64   E0;
+} RASTER_EDGE;
+
+typedef struct {
+    RASTER_EDGE Edge[3];    // edge i is opposite vertex i
+    INT64       Area;       // twice area, subpixel units squared
+    BOOLEAN     Swapped;    // vertex 1 and 2 swapped to make area positive
+    INT32       MinX;       // pixel bounds within clip window
+    INT32       MinY;
+    INT32       MaxX;
+    INT32       MaxY;
+} RASTER_TRI;
+
+// Edge bound floor(E/S) stepped per row as quotient and remainder
+typedef struct {
+    INT64   Q;
+    INT64   R;
+    INT64   Dq;
+    INT64   Dr;
+    INT64   S;
+} RASTER_BOUND;
+
+// Gouraud shading, per channel (red, green, blue) planes in 16.16
+typedef struct {
+    INT64   Base[3];    // channels at vertex 0
+    INT64   D1[3];      // channel differences from vertex 0 at the vertices opposite edges 1 and 2
+    INT64   D2[3];
+    INT64   Gx[3];      // change per pixel
+} SHADE_INFO;
+
+#define SHADE_MAX               (((INT64)256 << 16) - 1)
+
+// Texture mapping, texel coords are 16.16 planes over the triangle
+typedef struct {
+    CONST RENDER_BUFFER *Texture;
+    UINT32              Flags;
+    UINT32              ColourKey;
+    INT64               X0;     // vertex 0, subpixel
+    INT64               Y0;
+    INT64               U0;     // texel coords at vertex 0
+    INT64               V0;
+    INT64               Gux;    // change per pixel
+    INT64               Guy;
+    INT64               Gvx;
+    INT64               Gvy;
+} TEX_INFO;
+
+#define PLANE_MAX_DELTA         ((INT64)1 << 28)    // max difference between vertex values (16.16)
+#define PLANE_MAX_GRADIENT      ((INT64)1 << 28)    // max plane change per pixel (16.16)
+#define PLANE_WEIGHT_BITS       30                  // fraction bits of a barycentric weight
+
+// 3D mesh, vertex in clip space (16.16) with a bit set in Outcode per clip plane it is outside
+typedef struct {
+    INT64   X;
+    INT64   Y;
+    INT64   Z;
+    INT64   W;
+    UINT32  Outcode;
+} CLIP_VERTEX;
+
+// Depth tested fill, depth is a plane over the triangle (DEPTH_BITS fraction bits)
+typedef struct {
+    UINT32  Colour;
+    INT64   X0;     // vertex 0, subpixel
+    INT64   Y0;
+    INT64   Z0;     // depth at vertex 0
+    INT64   Gx;     // change per pixel
+    INT64   Gy;
+} DEPTH_INFO;
+
+#define DEPTH_CLEAR             0xFFFF                          // far, nothing drawn is deeper
+#define DEPTH_BITS              12
+#define DEPTH_MAX               ((INT64)0xFFFF << DEPTH_BITS)
+#define CLIP_MAX_ORD            ((INT64)1 << 24)    // clip coords are scaled below this so clipping stays within 64 bits
+#define CLIP_GUARD              256                 // |x|,|y| <= CLIP_GUARD*w keeps projected vertices inside RASTER_GUARD_BAND
+#define CLIP_PLANES             6
+#define CLIP_MAX_VERTICES       (3 + CLIP_PLANES)
+
+// Polygon edge, active for rows [y, YBot), x stepped as in raster_triangle()
+typedef struct {
+    RASTER_BOUND    Bound;      // floor(x) as Q + R/S
+    INT32           YBot;
+    INT32           Winding;    // +1 downwards, -1 upwards
+    INT64           X;          // first pixel at or right of edge on current row
+} POLY_EDGE;
+
+#define POLY_MAX_ORD            (1 << 30)   // keeps edge set up within 64 bits
+
+// Convex pieces of a thick line in 28.4, filled together as one non-zero polygon
+typedef struct {
+    POINT       *Points;
+    UINTN       *Counts;
+    UINTN       NumPoints;
+    UINTN       MaxPoints;
+    UINTN       NumContours;
+    UINTN       MaxContours;
+    INT64       X0;         // clip window's pixel centres, pieces wholly outside it are dropped
+    INT64       Y0;
+    INT64       X1;
+    INT64       Y1;
+    EFI_STATUS  Status;     // first allocation failure, pieces after it are dropped
+} STROKE;
+
+#define PEN_MAX_WIDTH           4096
+#define PEN_MAX_ORD             (1 << 24)   // with PEN_MAX_WIDTH keeps stroke points in 28.4 within POLY_MAX_ORD
+#define PEN_MITER_LIMIT         4           // longest miter as a multiple of half the width, as SVG's default
+#define PEN_MAX_ARC             360         // most points in a round cap or join
+#define STROKE_MAX_POINTS       (1 << 19)   // caps the stroke at 4 MB of points
+#define LINE_MAX_ORD            (1 << 28)   // keeps draw_line() error terms within 32 bits
+#define ELLIPSE_MAX_RADIUS      0x7FFF      // keeps (2rx + 1)^2 * (2ry + 1)^2 within 64 bits
+#define BEZIER_MAX_SHIFT        9           // at most 512 segments per curve
+#define BEZIER_FRAC_BITS        27          // 3 * BEZIER_MAX_SHIFT, forward differences of LINE_MAX_ORD curves fit 63 bits
+
+// Rows of an ellipse, the half width of row v is the largest U with 4U^2 * B2 + 4v^2 * A2 <= A2 * B2
+typedef struct {
+    UINT64  A2;     // (2rx + 1)^2
+    UINT64  B2;     // (2ry + 1)^2
+    INT64   Ry;
+    INT64   V;      // row U is for, -1 before the first
+    UINT64  U;
+} ELLIPSE_ROWS;
+
+// Sector clockwise (on screen) from direction (Cs, Ss) to (Ce, Se), 16.16
+typedef struct {
+    INT64   Cs;
+    INT64   Ss;
+    INT64   Ce;
+    INT64   Se;
+    BOOLEAN Reflex;     // over 180 degrees, everything but the opposite wedge
+} SECTOR;
+
+// Box [X0, X1] x [Y0, Y1] grown by an ellipse with radii Rx, Ry, a point box is an ellipse
+typedef struct {
+    INT64           X0;
+    INT64           Y0;
+    INT64           X1;
+    INT64           Y1;
+    INT32           Rx;
+    INT32           Ry;
+    CONST SECTOR    *Sector;    // NULL for all of it, else about (X0, Y0)
+    BOOLEAN         Clip;       // FALSE when it is inside the clip rectangle
+} ROUND_SHAPE;
+
+#define SHAPE_SETMEM_MIN        16          // longer spans are set with SetMem32()
+#define ARC_OUTLINE             0
+#define ARC_PIE                 1
+#define ARC_FILL_PIE            2
+#define GRADIENT_MAX_ORD        (1 << 16)   // keeps a linear gradient's index products within 63 bits
+#define GRADIENT_STEPS          256         // colours in a gradient's table
+#define GRADIENT_TOP            ((INT64)(GRADIENT_STEPS - 1) << 16)
+#define RADIAL_LUT_SIZE         (1 << 14)   // squared distance steps over a radial gradient's radius
+
+// Flood fill span, row Y is searched from X0 to X1 having come from row Y - Dy
+typedef struct {
+    INT32   Y;
+    INT32   X0;
+    INT32   X1;
+    INT32   Dy;
+} FLOOD_SPAN;
+
+typedef struct {
+    FLOOD_SPAN  *Spans;
+    UINTN       Num;
+    UINTN       Max;
+} FLOOD_STACK;
+
+#define FLOOD_STACK_SPANS       1024        // allocated up front, 16 KB
+#define FLOOD_MAX_SPANS         (1 << 18)   // caps the stack at 4 MB
+
+// Gradient set up for drawing, a pixel's place along it is an index into
+// Colours with 16 fraction bits
+typedef struct {
+    CONST GRADIENT  *Gradient;
+    UINT32          Colours[GRADIENT_STEPS];
+    INT64           Dx;         // linear, end point less start point
+    INT64           Dy;
+    INT64           L2;         // linear, squared length
+    INT64           Step;       // linear, index change per pixel along a row, and remainder over L2
+    INT64           StepRem;
+    UINT64          R2;         // radial, squared radius
+    UINT64          InvR2;      // radial, RADIAL_LUT_SIZE / R2 in 32.32
+} GRADIENT_PAINT;
+
+// Signed area coverage accumulation, a row's running sum is the coverage of
+// each pixel (16.16), Acc has Width + 2 entries per row for cells past the edge.
+// Rows are independent so a path is accumulated one band of rows at a time
+typedef struct {
+    INT32   *Acc;
+    INT32   X0;         // pixel origin
+    INT32   Y0;
+    INT32   Width;
+    INT32   Height;
+} COVERAGE;
+
+#define COVERAGE_ONE            0x10000
+#define PATH_CLOSED             0x80000000UL    // contour flag
+#define PATH_TOLERANCE          0x4000          // max flattening error (16.16), 1/4 pixel
+#define PATH_MAX_DEPTH          16              // curve subdivision limit
+#define PATH_BAND_ROWS          32              // coverage rows accumulated and blended per pass
+#define PATH_MAX_ORD            (1 << 29)       // max |x|,|y| and stroke width (16.16), keeps stroke and coverage products within 63 bits
+
+// Wu line in major/minor terms, pixel k is at Start + k*Major + (k*Rise / Length)*Minor
+typedef struct {
+    INT32   X0;
+    INT32   Y0;
+    INT32   Length;     // major axis steps to the end point
+    INT32   Rise;       // minor axis steps to the end point
+    INT32   Mx;         // major axis step
+    INT32   My;
+    INT32   Nx;         // minor axis step
+    INT32   Ny;
+    UINT32  WStep;      // 256*Rise / Length, weight per major step
+    UINT32  WRem;       // and its remainder
+} AA_LINE;
+
+typedef VOID (*RASTER_SPAN)(GFX_CONTEXT *Ctx, CONST RASTER_TRI *Tri, INT32 y, INT32 xl, INT32 xr, VOID *Data);
+
 // prototypes
 STATIC VOID init_globals(VOID);
 STATIC VOID init_renbuf(RENDER_BUFFER *RenBuf, INT32 HorRes, INT32 VerRes, INT32 PixPerScnLn, UINT32 *PixelData);
-STATIC VOID set_clipping(RENDER_BUFFER *RenBuf, INT32 x0, INT32 y0, INT32 x1, INT32 y1);
-STATIC VOID reset_clipping(RENDER_BUFFER *RenBuf);
-STATIC BOOLEAN clipped(RENDER_BUFFER *RenBuf);
-STATIC VOID draw_line(INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour);
-STATIC VOID draw_part_circle(INT32 xc, INT32 yc, INT32 r, UINT32 colour);
+STATIC VOID select_render_buffer(RENDER_BUFFER *RenBuf, BOOLEAN RenderToScreen);
+STATIC BOOLEAN check_context(GFX_CONTEXT *Ctx);
+STATIC VOID set_clipping(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1);
+STATIC VOID store_clipping(GFX_CONTEXT *Ctx);
+STATIC VOID reset_clipping(GFX_CONTEXT *Ctx);
+STATIC BOOLEAN clipped(GFX_CONTEXT *Ctx);
+STATIC VOID clear_screen(GFX_CONTEXT *Ctx, UINT32 colour);
+STATIC VOID clear_clip_window(GFX_CONTEXT *Ctx, UINT32 colour);
+STATIC VOID put_pixel(GFX_CONTEXT *Ctx, INT32 x, INT32 y, UINT32 colour);
+STATIC UINT32 get_pixel(GFX_CONTEXT *Ctx, INT32 x, INT32 y);
+STATIC EFI_STATUS get_surface(GFX_CONTEXT *Ctx, GFX_SURFACE *Surface);
+STATIC VOID draw_vline(GFX_CONTEXT *Ctx, INT32 x, INT32 y, INT32 height, UINT32 colour);
+STATIC VOID clip_line(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour);
+STATIC EFI_STATUS draw_lines(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, BOOLEAN Connected, UINT32 colour);
+STATIC VOID draw_line_aa(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour);
+STATIC BOOLEAN draw_full_line_aa(GFX_CONTEXT *Ctx, CONST AA_LINE *Line, INT32 x1, INT32 y1, UINT32 colour);
+STATIC VOID draw_part_line_aa(GFX_CONTEXT *Ctx, CONST AA_LINE *Line, UINT32 colour);
+STATIC UINT32 step_line_aa(CONST AA_LINE *Line, UINT32 w, UINT32 *r);
+STATIC UINT32 lerp_colour(UINT32 a, UINT32 b, UINT32 f);
+STATIC EFI_STATUS draw_bezier(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, BOOLEAN AntiAlias, UINT32 colour);
+STATIC VOID draw_line(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 dx, INT32 dy, INT32 error, UINT32 colour);
+STATIC VOID draw_line_runs(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 dx, INT32 dy, INT32 error, UINT32 colour);
+STATIC VOID draw_triangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 colour);
+STATIC VOID draw_fill_triangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 colour);
+STATIC VOID draw_rectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour);
+STATIC VOID draw_fill_rectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour);
+STATIC UINTN draw_fill_rects(GFX_CONTEXT *Ctx, CONST RECT *Rects, CONST UINT32 *Colours, UINTN Count);
+STATIC UINTN draw_sorted_rects(GFX_CONTEXT *Ctx, CONST RECT *Rects, CONST UINT32 *Colours, UINTN Count);
+STATIC BOOLEAN clip_rect(CONST GFX_CONTEXT *Ctx, CONST RECT *Rect, RECT *Clip);
+STATIC VOID draw_circle(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 r, UINT32 colour);
+STATIC VOID draw_part_circle(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 r, UINT32 colour);
+STATIC INT64 circle_y(INT64 r, INT64 i);
+STATIC INT64 circle_step(INT64 r, INT64 yMax);
+STATIC INT64 circle_seed(INT64 r, INT64 i, INT64 *y, INT64 *d);
+STATIC VOID draw_circle_octant(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 r, INT32 Sx, INT32 Sy, BOOLEAN Swap, UINT32 colour);
 #if CIRCLE_OPTIMISATION
-STATIC BOOLEAN draw_full_circle(INT32 xc, INT32 yc, INT32 r, UINT32 colour);
+STATIC BOOLEAN draw_full_circle(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 r, UINT32 colour);
 #endif
+STATIC VOID draw_fill_circle(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 r, UINT32 colour, CONST BRUSH *Brush);
+STATIC VOID draw_mirrored_span(GFX_CONTEXT *Ctx, INT64 x0, INT64 y0, INT64 x1, INT64 y1, INT64 dy, INT64 HalfWidth, UINT32 colour, CONST BRUSH *Brush);
+STATIC INT64 ellipse_half_width(ELLIPSE_ROWS *Rows, INT64 v);
+STATIC BOOLEAN init_round_shape(GFX_CONTEXT *Ctx, ROUND_SHAPE *Shape, INT64 x0, INT64 y0, INT64 x1, INT64 y1, INT32 rx, INT32 ry, CONST SECTOR *Sector);
+STATIC VOID clip_half_plane(INT64 c0, INT64 c1, INT64 *Lo, INT64 *Hi);
+STATIC VOID draw_shape_span(GFX_CONTEXT *Ctx, CONST ROUND_SHAPE *Shape, INT64 y, INT64 x0, INT64 x1, UINT32 colour);
+STATIC VOID fill_shape_row(UINT32 *Row, INT64 x0, INT64 x1, UINT32 colour);
+STATIC VOID draw_outline_row(GFX_CONTEXT *Ctx, CONST ROUND_SHAPE *Shape, INT64 y, INT64 HalfWidth, INT64 NextWidth, UINT32 colour);
+STATIC VOID draw_round_shape(GFX_CONTEXT *Ctx, CONST ROUND_SHAPE *Shape, BOOLEAN Fill, UINT32 colour);
+STATIC EFI_STATUS draw_ellipse(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 rx, INT32 ry, BOOLEAN Fill, UINT32 colour);
+STATIC EFI_STATUS draw_arc(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 rx, INT32 ry, INT32 StartAngle, INT32 EndAngle, UINT32 Kind, UINT32 colour);
+STATIC VOID ellipse_point(INT32 rx, INT32 ry, INT64 c, INT64 s, INT64 *x, INT64 *y);
+STATIC EFI_STATUS draw_rounded_rectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 r, BOOLEAN Fill, UINT32 colour);
+STATIC EFI_STATUS flood_fill(GFX_CONTEXT *Ctx, INT32 x, INT32 y, UINT32 colour);
+STATIC INT32 flood_run(CONST UINT32 *Row, INT32 x, INT32 Limit, INT32 Step, UINT32 Target);
+STATIC EFI_STATUS flood_push(GFX_CONTEXT *Ctx, FLOOD_STACK *Stack, INT32 y, INT32 x0, INT32 x1, INT32 dy);
+STATIC EFI_STATUS draw_gradient_rectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, CONST GRADIENT *Gradient);
+STATIC EFI_STATUS init_gradient(GRADIENT_PAINT *Paint, CONST GRADIENT *Gradient);
+STATIC VOID gradient_row(CONST GRADIENT_PAINT *Paint, INT32 x0, INT32 x1, INT32 y, UINT32 *Dst);
+STATIC EFI_STATUS draw_brush_rectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, CONST BRUSH *Brush);
+STATIC BOOLEAN check_brush(CONST BRUSH *Brush);
+STATIC VOID brush_span(CONST BRUSH *Brush, UINT32 *Row, INT64 xl, INT64 xr, INT64 y);
+STATIC UINTN draw_points(GFX_CONTEXT *Ctx, CONST POINT *Points, CONST UINT32 *Colours, UINTN Count, UINT32 colour);
+STATIC UINTN draw_sorted_points(GFX_CONTEXT *Ctx, CONST POINT *Points, CONST UINT32 *Colours, UINTN Count, UINT32 colour);
+STATIC VOID draw_plot(GFX_CONTEXT *Ctx, CONST INT32 *Samples, UINTN Count, INT32 MinVal, INT32 MaxVal, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour);
+STATIC UINTN append_strip_chart(GFX_CONTEXT *Ctx, STRIP_CHART *Chart, CONST INT32 *Samples, UINTN Count);
+STATIC VOID scroll_left(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 n, UINT32 colour);
+STATIC EFI_STATUS draw_heatmap(GFX_CONTEXT *Ctx, CONST VOID *Cells, HEATMAP_FORMAT Format, UINT32 Cols, UINT32 Rows, UINT32 Pitch, CONST UINT32 *Lut, UINT32 LutSize, INT32 x0, INT32 y0, INT32 x1, INT32 y1);
+STATIC VOID draw_mesh_triangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 colour);
+STATIC VOID fill_span(GFX_CONTEXT *Ctx, CONST RASTER_TRI *Tri, INT32 y, INT32 xl, INT32 xr, VOID *Data);
+STATIC BOOLEAN raster_setup(GFX_CONTEXT *Ctx, RASTER_TRI *Tri, INT64 x0, INT64 y0, INT64 x1, INT64 y1, INT64 x2, INT64 y2);
+STATIC VOID raster_triangle(GFX_CONTEXT *Ctx, CONST RASTER_TRI *Tri, RASTER_SPAN Span, VOID *Data);
+STATIC VOID draw_shaded_triangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 c0, UINT32 c1, UINT32 c2);
+STATIC VOID shade_span(GFX_CONTEXT *Ctx, CONST RASTER_TRI *Tri, INT32 y, INT32 xl, INT32 xr, VOID *Data);
+STATIC VOID plane_setup(CONST RASTER_TRI *Tri, CONST INT64 *P, INT64 *Gx, INT64 *Gy);
+STATIC INT64 plane_gradient(INT64 S, INT64 Area);
+STATIC INT64 plane_weight(CONST RASTER_EDGE *Edge, INT32 x, INT32 y, INT64 Area);
+STATIC EFI_STATUS draw_textured_triangle(GFX_CONTEXT *Ctx, CONST RENDER_BUFFER *Texture, CONST TEX_VERTEX *v0, CONST TEX_VERTEX *v1, CONST TEX_VERTEX *v2, UINT32 Flags, UINT32 ColourKey);
+STATIC EFI_STATUS draw_textured_quad(GFX_CONTEXT *Ctx, CONST RENDER_BUFFER *Texture, CONST TEX_VERTEX *Vertex, UINT32 Flags, UINT32 ColourKey);
+STATIC EFI_STATUS draw_sprite_affine(GFX_CONTEXT *Ctx, CONST RENDER_BUFFER *Sprite, INT32 px, INT32 py, INT32 x, INT32 y, CONST INT32 *Matrix, UINT32 Flags, UINT32 ColourKey);
+STATIC VOID rotation_matrix(INT32 Angle, UINT32 Scale, INT32 *Matrix);
+STATIC EFI_STATUS draw_mesh(GFX_CONTEXT *Ctx, CONST MATRIX4 *Transform, CONST VERTEX3 *Vertices, UINTN NumVertices, CONST UINT32 *Indices, UINTN NumTriangles, CONST UINT32 *Colours, UINT32 Flags);
+STATIC VOID transform_vertex(CONST MATRIX4 *Transform, CONST VERTEX3 *Vertex, CLIP_VERTEX *Clip);
+STATIC INT64 clip_distance(CONST CLIP_VERTEX *Vertex, UINTN Plane);
+STATIC UINTN clip_polygon(CLIP_VERTEX *Poly, UINTN Count, UINT32 Planes);
+STATIC VOID draw_mesh_polygon(GFX_CONTEXT *Ctx, CONST CLIP_VERTEX *Poly, UINTN Count, UINT32 Colour, UINT32 Flags);
+STATIC VOID depth_span(GFX_CONTEXT *Ctx, CONST RASTER_TRI *Tri, INT32 y, INT32 xl, INT32 xr, VOID *Data);
+STATIC EFI_STATUS draw_fill_polygon(GFX_CONTEXT *Ctx, CONST POINT *Points, CONST UINTN *Counts, UINTN NumContours, UINT32 Shift, FILL_RULE Rule, UINT32 colour, CONST BRUSH *Brush);
+STATIC UINTN build_edge_table(GFX_CONTEXT *Ctx, CONST POINT *Points, CONST UINTN *Counts, UINTN NumContours, UINT32 Shift, POLY_EDGE *Edges);
+STATIC VOID fill_polygon_row(GFX_CONTEXT *Ctx, POLY_EDGE **Active, UINTN NumActive, INT32 y, FILL_RULE Rule, UINT32 colour, CONST BRUSH *Brush);
+STATIC VOID sort_edges(POLY_EDGE **Edges, UINTN Count);
+STATIC VOID sift_edge(POLY_EDGE **Edges, UINTN i, UINTN Count);
+STATIC EFI_STATUS draw_thick_polyline(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, CONST PEN *Pen, UINT32 colour);
+STATIC VOID stroke_polyline(GFX_CONTEXT *Ctx, STROKE *Stroke, CONST POINT *Points, UINTN Count, CONST PEN *Pen, UINT32 colour);
+STATIC BOOLEAN stroke_window(CONST STROKE *Stroke, INT64 Ax, INT64 Ay, INT64 Dx, INT64 Dy, INT64 Len, INT64 Margin, INT64 *Enter, INT64 *Leave);
+STATIC INT64 stroke_skip(CONST PEN *Pen, INT64 Pattern, INT64 Dist, UINTN *d, BOOLEAN *On, INT64 *Rem);
+STATIC VOID stroke_cap(STROKE *Stroke, LINE_CAP Cap, INT64 h, INT64 x, INT64 y, INT64 Nx, INT64 Ny, BOOLEAN Start);
+STATIC VOID stroke_join(STROKE *Stroke, LINE_JOIN Join, INT64 h, INT64 x, INT64 y, INT64 N1x, INT64 N1y, INT64 N2x, INT64 N2y, INT64 Cross);
+STATIC VOID stroke_circle(STROKE *Stroke, INT64 x, INT64 y, INT64 r);
+STATIC VOID stroke_add(STROKE *Stroke, CONST INT64 *X, CONST INT64 *Y, UINTN Count);
+STATIC EFI_STATUS path_add_point(GFX_PATH *Path, INT64 x, INT64 y);
+STATIC EFI_STATUS path_begin(GFX_PATH *Path, INT64 x, INT64 y);
+STATIC EFI_STATUS path_current(GFX_PATH *Path, INT64 *x, INT64 *y);
+STATIC EFI_STATUS flatten_quad(GFX_PATH *Path, INT64 x0, INT64 y0, INT64 x1, INT64 y1, INT64 x2, INT64 y2, UINTN Depth);
+STATIC EFI_STATUS flatten_cubic(GFX_PATH *Path, INT64 x0, INT64 y0, INT64 x1, INT64 y1, INT64 x2, INT64 y2, INT64 x3, INT64 y3, UINTN Depth);
+STATIC BOOLEAN check_path(CONST GFX_PATH *Path);
+STATIC BOOLEAN check_path_point(INT64 x, INT64 y);
+STATIC EFI_STATUS draw_path(GFX_CONTEXT *Ctx, CONST GFX_PATH *Path, BOOLEAN Stroke, INT32 Width, FILL_RULE Rule, UINT32 colour, CONST GRADIENT_PAINT *Paint);
+STATIC EFI_STATUS draw_gradient_path(GFX_CONTEXT *Ctx, CONST GFX_PATH *Path, FILL_RULE Rule, CONST GRADIENT *Gradient);
+STATIC VOID fill_path(COVERAGE *Cov, CONST GFX_PATH *Path);
+STATIC VOID stroke_path(COVERAGE *Cov, CONST GFX_PATH *Path, INT64 HalfWidth);
+STATIC VOID coverage_polygon(COVERAGE *Cov, CONST INT64 *X, CONST INT64 *Y, UINTN Count);
+STATIC VOID coverage_line(COVERAGE *Cov, INT64 x0, INT64 y0, INT64 x1, INT64 y1);
+STATIC VOID coverage_row(INT32 *Acc, INT64 xa, INT64 xb, INT64 d);
+STATIC VOID composite_coverage(GFX_CONTEXT *Ctx, CONST COVERAGE *Cov, FILL_RULE Rule, UINT32 colour, CONST GRADIENT_PAINT *Paint, UINT32 *RowColours);
+STATIC UINT64 isqrt64(UINT64 n);
 #define FONT_WIDTH(FontData) FontData[14]
 #define FONT_HEIGHT(FontData) FontData[15]
 STATIC CONST UINT8 *get_font_data(FONT Font);
@@ -58,9 +399,13 @@ STATIC CONST UINT8 *get_char_bitmap(CONST UINT8 *FontData, UINT16 Code);
 STATIC VOID init_text_config(TEXT_CONFIG *TxtCfg, INT32 x, INT32 y, INT32 Width, INT32 Height, UINT32 FgColour, UINT32 BgColour, FONT Font);
 STATIC VOID default_text_config(TEXT_CONFIG *TxtCfg, INT32 Width, INT32 Height);
 STATIC EFI_STATUS put_string(RENDER_BUFFER *RenBuf, TEXT_CONFIG *TxtCfgOvr, UINT16 *string);
+STATIC VOID EFIAPI job_worker(VOID *Buffer);
+STATIC BOOLEAN parallel_fill(UINT32 *ptr, UINT32 width, UINT32 height, UINT32 PixPerScnLn, UINT32 colour);
 
 STATIC BOOLEAN Initialised = FALSE;
 #define RENBUF_SIG 0x52425546UL   // "RBUF"
+#define CONTEXT_SIG 0x58544347UL  // "GCTX"
+#define PATH_SIG 0x48544150UL     // "PATH"
 
 // globals
 STATIC UINT32                           gOrigGfxMode = 0;
@@ -68,8 +413,7 @@ STATIC UINTN                            gOrigTxtMode = 0;
 STATIC EFI_GRAPHICS_OUTPUT_PROTOCOL     *gGop = NULL;
 STATIC UINT32                           gCurrMode = 0;
 STATIC RENDER_BUFFER                    gFrameBuffer = {0};
-STATIC RENDER_BUFFER                    *gCurrRenBuf = NULL;
-STATIC BOOLEAN                          gRenderToScreen = TRUE;
+STATIC GFX_CONTEXT                      gCurrCtx = {0};     // default context used by non Ctx functions
 
 
 // macros
@@ -105,12 +449,15 @@ STATIC VOID init_globals(VOID)
     DbgPrint(DL_INFO, "%a()\n", __func__);
 
     gCurrMode = gGop->Mode->Mode;
+    // depth buffer no longer matches the resolution
+    if (gFrameBuffer.DepthData) {
+        FreePool(gFrameBuffer.DepthData);
+    }
     init_renbuf(&gFrameBuffer, gGop->Mode->Info->HorizontalResolution, gGop->Mode->Info->VerticalResolution, gGop->Mode->Info->PixelsPerScanLine, (UINT32 *)gGop->Mode->FrameBufferBase);
     default_text_config(&gFrameBuffer.TxtCfg, gFrameBuffer.HorRes, gFrameBuffer.VerRes);
 
     // Default to screen
-    gCurrRenBuf = &gFrameBuffer;
-    gRenderToScreen = TRUE;
+    select_render_buffer(&gFrameBuffer, TRUE);
 }
 
 EFI_STATUS RestoreConsole(VOID)
@@ -249,8 +596,12 @@ STATIC VOID init_renbuf(RENDER_BUFFER *RenBuf, INT32 HorRes, INT32 VerRes, INT32
     RenBuf->HorRes = HorRes;
     RenBuf->VerRes = VerRes;
     RenBuf->PixPerScnLn = PixPerScnLn;
-    reset_clipping(RenBuf);
+    RenBuf->ClipX0 = 0;
+    RenBuf->ClipY0 = 0;
+    RenBuf->ClipX1 = HorRes - 1;
+    RenBuf->ClipY1 = VerRes - 1;
     RenBuf->PixelData = PixelData;
+    RenBuf->DepthData = NULL;
 }
 
 EFI_STATUS CreateRenderBuffer(RENDER_BUFFER *RenBuf, UINT32 Width, UINT32 Height)
@@ -298,11 +649,14 @@ EFI_STATUS DestroyRenderBuffer(RENDER_BUFFER *RenBuf)
         FreePool(RenBuf->PixelData);
         RenBuf->PixelData = NULL;
     }
-    if (RenBuf == gCurrRenBuf) {
+    if (RenBuf->DepthData) {
+        FreePool(RenBuf->DepthData);
+        RenBuf->DepthData = NULL;
+    }
+    if (RenBuf == gCurrCtx.RenBuf) {
         // if we are destroying the current render buffer then
         // revert to frame buffer
-        gCurrRenBuf = &gFrameBuffer;
-        gRenderToScreen = TRUE;
+        select_render_buffer(&gFrameBuffer, TRUE);
     }
     ZeroMem(RenBuf, sizeof(RENDER_BUFFER));
 
@@ -325,8 +679,7 @@ EFI_STATUS SetRenderBuffer(RENDER_BUFFER *RenBuf)
         DbgPrint(DL_ERROR, "%a(), Invalid Render Buffer => EFI_INVALID_PARAMETER\n", __func__);
         return EFI_INVALID_PARAMETER;
     }
-    gCurrRenBuf = RenBuf;
-    gRenderToScreen = FALSE;
+    select_render_buffer(RenBuf, FALSE);
 
     return EFI_SUCCESS;
 }
@@ -339,12 +692,83 @@ EFI_STATUS SetScreenRender(VOID)
         DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
         return EFI_NOT_READY;
     }
-    gCurrRenBuf = &gFrameBuffer;
-    gRenderToScreen = TRUE;
+    select_render_buffer(&gFrameBuffer, TRUE);
+
+    return EFI_SUCCESS;
+}
+
+/*
+ * select_render_buffer() - make render buffer the target of the default context
+ */
+STATIC VOID select_render_buffer(RENDER_BUFFER *RenBuf, BOOLEAN RenderToScreen)
+{
+    DbgPrint(DL_INFO, "%a(RenBuf=0x%p, RenderToScreen=%u)\n", __func__, RenBuf, RenderToScreen);
+
+    gCurrCtx.Sig = CONTEXT_SIG;
+    gCurrCtx.RenBuf = RenBuf;
+    gCurrCtx.RenderToScreen = RenderToScreen;
+    // clip window is kept with each render buffer
+    gCurrCtx.ClipX0 = RenBuf->ClipX0;
+    gCurrCtx.ClipY0 = RenBuf->ClipY0;
+    gCurrCtx.ClipX1 = RenBuf->ClipX1;
+    gCurrCtx.ClipY1 = RenBuf->ClipY1;
+}
+
+EFI_STATUS CreateContext(GFX_CONTEXT *Ctx, RENDER_BUFFER *RenBuf)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, RenBuf=0x%p)\n", __func__, Ctx, RenBuf);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    if (!Ctx) {
+        DbgPrint(DL_ERROR, "%a(), Ctx=NULL => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    // determine render buffer targeted (NULL == Screen)
+    Ctx->RenBuf = RenBuf ? RenBuf : &gFrameBuffer;
+    if (Ctx->RenBuf->Sig != RENBUF_SIG) {
+        ZeroMem(Ctx, sizeof(GFX_CONTEXT));
+        DbgPrint(DL_ERROR, "%a(), Invalid Render Buffer => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    Ctx->Sig = CONTEXT_SIG;
+    Ctx->RenderToScreen = (Ctx->RenBuf == &gFrameBuffer);
+    reset_clipping(Ctx);
+    default_text_config(&Ctx->TxtCfg, Ctx->RenBuf->HorRes, Ctx->RenBuf->VerRes);
 
     return EFI_SUCCESS;
 }
 
+/*
+ * check_context() - return TRUE if context can be drawn to
+ *
+ * The render buffer may have been destroyed and recreated smaller since
+ * the context was created, so its clip window is clamped to the buffer.
+ */
+STATIC BOOLEAN check_context(GFX_CONTEXT *Ctx)
+{
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised\n", __func__);
+        return FALSE;
+    }
+    if (!Ctx || Ctx->Sig != CONTEXT_SIG) {
+        DbgPrint(DL_ERROR, "%a(), Invalid Context\n", __func__);
+        return FALSE;
+    }
+    if (Ctx->RenBuf->Sig != RENBUF_SIG) {
+        DbgPrint(DL_ERROR, "%a(), Invalid Render Buffer\n", __func__);
+        return FALSE;
+    }
+    if (Ctx->ClipX0 < 0 || Ctx->ClipY0 < 0 ||
+        Ctx->ClipX1 >= (INT32)Ctx->RenBuf->HorRes || Ctx->ClipY1 >= (INT32)Ctx->RenBuf->VerRes) {
+        DbgPrint(DL_WARN, "%a(), clip window outside render buffer, clamped\n", __func__);
+        set_clipping(Ctx, Ctx->ClipX0, Ctx->ClipY0, Ctx->ClipX1, Ctx->ClipY1);
+    }
+    return TRUE;
+}
+
 EFI_STATUS DisplayRenderBuffer(RENDER_BUFFER *RenBuf, INT32 x, INT32 y)
 {
     DbgPrint(DL_INFO, "%a(RenBuf=0x%p, x=%d, y=%d)\n", __func__, RenBuf, x, y);
@@ -405,6 +829,81 @@ EFI_STATUS DisplayRenderBuffer(RENDER_BUFFER *RenBuf, INT32 x, INT32 y)
     return Status;
 }
 
+EFI_STATUS CreateDepthBuffer(RENDER_BUFFER *RenBuf)
+{
+    DbgPrint(DL_INFO, "%a(RenBuf=0x%p)\n", __func__, RenBuf);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    // NULL == Screen
+    if (!RenBuf) {
+        RenBuf = &gFrameBuffer;
+    }
+    if (RenBuf->Sig != RENBUF_SIG) {
+        DbgPrint(DL_ERROR, "%a(), Invalid Render Buffer => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    if (!RenBuf->DepthData) {
+        RenBuf->DepthData = AllocatePool(RenBuf->HorRes * RenBuf->VerRes * sizeof(UINT16));
+        if (RenBuf->DepthData == NULL) {
+            DbgPrint(DL_ERROR, "%a(), memory allocation error => EFI_OUT_OF_RESOURCES\n", __func__);
+            return EFI_OUT_OF_RESOURCES;
+        }
+    }
+    SetMem16(RenBuf->DepthData, RenBuf->HorRes * RenBuf->VerRes * sizeof(UINT16), DEPTH_CLEAR);
+
+    return EFI_SUCCESS;
+}
+
+EFI_STATUS ClearDepthBuffer(RENDER_BUFFER *RenBuf)
+{
+    DbgPrint(DL_INFO, "%a(RenBuf=0x%p)\n", __func__, RenBuf);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    if (!RenBuf) {
+        RenBuf = &gFrameBuffer;
+    }
+    if (RenBuf->Sig != RENBUF_SIG) {
+        DbgPrint(DL_ERROR, "%a(), Invalid Render Buffer => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    if (!RenBuf->DepthData) {
+        DbgPrint(DL_ERROR, "%a(), no depth buffer => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    SetMem16(RenBuf->DepthData, RenBuf->HorRes * RenBuf->VerRes * sizeof(UINT16), DEPTH_CLEAR);
+
+    return EFI_SUCCESS;
+}
+
+EFI_STATUS DestroyDepthBuffer(RENDER_BUFFER *RenBuf)
+{
+    DbgPrint(DL_INFO, "%a(RenBuf=0x%p)\n", __func__, RenBuf);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    if (!RenBuf) {
+        RenBuf = &gFrameBuffer;
+    }
+    if (RenBuf->Sig != RENBUF_SIG) {
+        DbgPrint(DL_ERROR, "%a(), Invalid Render Buffer => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    if (RenBuf->DepthData) {
+        FreePool(RenBuf->DepthData);
+        RenBuf->DepthData = NULL;
+    }
+
+    return EFI_SUCCESS;
+}
+
 UINT32 GetHorRes(VOID)
 {
     DbgPrint(DL_INFO, "%a()\n", __func__);
@@ -413,7 +912,17 @@ UINT32 GetHorRes(VOID)
         DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised\n", __func__);
         return 0;
     }
-    return gCurrRenBuf->HorRes;
+    return gCurrCtx.RenBuf->HorRes;
+}
+
+UINT32 CtxGetHorRes(GFX_CONTEXT *Ctx)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p)\n", __func__, Ctx);
+
+    if (!check_context(Ctx)) {
+        return 0;
+    }
+    return Ctx->RenBuf->HorRes;
 }
 
 UINT32 GetVerRes(VOID)
@@ -424,86 +933,141 @@ UINT32 GetVerRes(VOID)
         DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised\n", __func__);
         return 0;
     }
-    return gCurrRenBuf->VerRes;
+    return gCurrCtx.RenBuf->VerRes;
+}
+
+UINT32 CtxGetVerRes(GFX_CONTEXT *Ctx)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p)\n", __func__, Ctx);
+
+    if (!check_context(Ctx)) {
+        return 0;
+    }
+    return Ctx->RenBuf->VerRes;
 }
 
 VOID SetClipping(INT32 x0, INT32 y0, INT32 x1, INT32 y1)
 {
     DbgPrint(DL_INFO, "%a(x0=%d, y0=%d, x1=%d, y1=%d)\n", __func__, x0, y0, x1, y1);
-    set_clipping(gCurrRenBuf, x0, y0, x1, y1);
+    set_clipping(&gCurrCtx, x0, y0, x1, y1);
+    store_clipping(&gCurrCtx);
+}
+
+VOID CtxSetClipping(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d)\n", __func__, Ctx, x0, y0, x1, y1);
+
+    if (!check_context(Ctx)) {
+        return;
+    }
+    set_clipping(Ctx, x0, y0, x1, y1);
 }
 
-VOID set_clipping(RENDER_BUFFER *RenBuf, INT32 x0, INT32 y0, INT32 x1, INT32 y1)
+STATIC VOID set_clipping(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1)
 {
-    DbgPrint(DL_INFO, "%a(RenBuf=0x%p, x0=%d, y0=%d, x1=%d, y1=%d)\n", __func__, x0, y0, x1, y1);
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d)\n", __func__, Ctx, x0, y0, x1, y1);
 
     // determine top-left bottom-right
     if (x0 < x1) {
-        RenBuf->ClipX0 = x0;
-        RenBuf->ClipX1 = x1;
+        Ctx->ClipX0 = x0;
+        Ctx->ClipX1 = x1;
     } else {
-        RenBuf->ClipX0 = x1;
-        RenBuf->ClipX1 = x0;
+        Ctx->ClipX0 = x1;
+        Ctx->ClipX1 = x0;
     }
     if (y0 < y1) {
-        RenBuf->ClipY0 = y0;
-        RenBuf->ClipY1 = y1;
+        Ctx->ClipY0 = y0;
+        Ctx->ClipY1 = y1;
     } else {
-        RenBuf->ClipY0 = y1;
-        RenBuf->ClipY1 = y0;
+        Ctx->ClipY0 = y1;
+        Ctx->ClipY1 = y0;
     }
     // clip to screen
-    if (RenBuf->ClipX0 < 0) {
-        RenBuf->ClipX0 = 0;
-    } else if (RenBuf->ClipX0 >= (INT32)RenBuf->HorRes) {
-        RenBuf->ClipX0 = RenBuf->HorRes - 1;
-    }
-    if (RenBuf->ClipX1 < 0) {
-        RenBuf->ClipX1 = 0;
-    } else if (RenBuf->ClipX1 >= (INT32)RenBuf->HorRes) {
-        RenBuf->ClipX1 = RenBuf->HorRes - 1;
-    }
-    if (RenBuf->ClipY0 < 0) {
-        RenBuf->ClipY0 = 0;
-    } else if (RenBuf->ClipY0 >= (INT32)RenBuf->VerRes) {
-        RenBuf->ClipY0 = RenBuf->VerRes - 1;
-    }
-    if (RenBuf->ClipY1 < 0) {
-        RenBuf->ClipY1 = 0;
-    } else if (RenBuf->ClipY1 >= (INT32)RenBuf->VerRes) {
-        RenBuf->ClipY1 = RenBuf->VerRes - 1;
+    if (Ctx->ClipX0 < 0) {
+        Ctx->ClipX0 = 0;
+    } else if (Ctx->ClipX0 >= (INT32)Ctx->RenBuf->HorRes) {
+        Ctx->ClipX0 = Ctx->RenBuf->HorRes - 1;
+    }
+    if (Ctx->ClipX1 < 0) {
+        Ctx->ClipX1 = 0;
+    } else if (Ctx->ClipX1 >= (INT32)Ctx->RenBuf->HorRes) {
+        Ctx->ClipX1 = Ctx->RenBuf->HorRes - 1;
+    }
+    if (Ctx->ClipY0 < 0) {
+        Ctx->ClipY0 = 0;
+    } else if (Ctx->ClipY0 >= (INT32)Ctx->RenBuf->VerRes) {
+        Ctx->ClipY0 = Ctx->RenBuf->VerRes - 1;
+    }
+    if (Ctx->ClipY1 < 0) {
+        Ctx->ClipY1 = 0;
+    } else if (Ctx->ClipY1 >= (INT32)Ctx->RenBuf->VerRes) {
+        Ctx->ClipY1 = Ctx->RenBuf->VerRes - 1;
     }
 }
 
+/*
+ * store_clipping() - save context clip window in its render buffer
+ */
+STATIC VOID store_clipping(GFX_CONTEXT *Ctx)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p)\n", __func__, Ctx);
+
+    Ctx->RenBuf->ClipX0 = Ctx->ClipX0;
+    Ctx->RenBuf->ClipY0 = Ctx->ClipY0;
+    Ctx->RenBuf->ClipX1 = Ctx->ClipX1;
+    Ctx->RenBuf->ClipY1 = Ctx->ClipY1;
+}
+
 VOID ResetClipping(VOID)
 {
     DbgPrint(DL_INFO, "%a()\n", __func__);
 
-    reset_clipping(gCurrRenBuf);
+    reset_clipping(&gCurrCtx);
+    store_clipping(&gCurrCtx);
 }
 
-STATIC VOID reset_clipping(RENDER_BUFFER *RenBuf)
+VOID CtxResetClipping(GFX_CONTEXT *Ctx)
 {
-    DbgPrint(DL_INFO, "%a(RenBuf=0x%p)\n", __func__, RenBuf);
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p)\n", __func__, Ctx);
 
-    RenBuf->ClipX0 = 0;
-    RenBuf->ClipY0 = 0;
-    RenBuf->ClipX1 = RenBuf->HorRes - 1;
-    RenBuf->ClipY1 = RenBuf->VerRes - 1;
+    if (!check_context(Ctx)) {
+        return;
+    }
+    reset_clipping(Ctx);
+}
+
+STATIC VOID reset_clipping(GFX_CONTEXT *Ctx)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p)\n", __func__, Ctx);
+
+    Ctx->ClipX0 = 0;
+    Ctx->ClipY0 = 0;
+    Ctx->ClipX1 = Ctx->RenBuf->HorRes - 1;
+    Ctx->ClipY1 = Ctx->RenBuf->VerRes - 1;
 }
 
 BOOLEAN Clipped(VOID)
 {
     DbgPrint(DL_INFO, "%a()\n", __func__);
 
-    return clipped(gCurrRenBuf);
+    return clipped(&gCurrCtx);
 }
 
-BOOLEAN clipped(RENDER_BUFFER *RenBuf)
+BOOLEAN CtxClipped(GFX_CONTEXT *Ctx)
 {
-    DbgPrint(DL_INFO, "%a(RenBuf=0x%p)\n", __func__, RenBuf);
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p)\n", __func__, Ctx);
+
+    if (!check_context(Ctx)) {
+        return FALSE;
+    }
+    return clipped(Ctx);
+}
+
+STATIC BOOLEAN clipped(GFX_CONTEXT *Ctx)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p)\n", __func__, Ctx);
 
-    if (RenBuf->ClipX0 != 0 || RenBuf->ClipY0 != 0 || RenBuf->ClipX1 != RenBuf->HorRes - 1 || RenBuf->ClipY1 != RenBuf->VerRes - 1) {
+    if (Ctx->ClipX0 != 0 || Ctx->ClipY0 != 0 || Ctx->ClipX1 != Ctx->RenBuf->HorRes - 1 || Ctx->ClipY1 != Ctx->RenBuf->VerRes - 1) {
         return TRUE;
     }
     return FALSE;
@@ -517,24 +1081,47 @@ VOID ClearScreen(UINT32 colour)
         DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised", __func__);
         return;
     }
-    if (gRenderToScreen) {
-        gGop->Blt(gGop, (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)&colour, EfiBltVideoFill, 0, 0, 0, 0, gCurrRenBuf->HorRes, gCurrRenBuf->VerRes, 0);
+    clear_screen(&gCurrCtx, colour);
+    // reset text position
+    gCurrCtx.RenBuf->TxtCfg.CurrX = gCurrCtx.RenBuf->TxtCfg.X0;
+    gCurrCtx.RenBuf->TxtCfg.CurrY = gCurrCtx.RenBuf->TxtCfg.Y0;
+}
+
+VOID CtxClearScreen(GFX_CONTEXT *Ctx, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, colour=0x%08X)\n", __func__, Ctx, colour);
+
+    if (!check_context(Ctx)) {
+        return;
+    }
+    clear_screen(Ctx, colour);
+    // reset text position
+    Ctx->TxtCfg.CurrX = Ctx->TxtCfg.X0;
+    Ctx->TxtCfg.CurrY = Ctx->TxtCfg.Y0;
+}
+
+STATIC VOID clear_screen(GFX_CONTEXT *Ctx, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, colour=0x%08X)\n", __func__, Ctx, colour);
+
+    RENDER_BUFFER *RenBuf = Ctx->RenBuf;
+    if (Ctx->RenderToScreen) {
+        gGop->Blt(gGop, (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)&colour, EfiBltVideoFill, 0, 0, 0, 0, RenBuf->HorRes, RenBuf->VerRes, 0);
     } else {
-        UINT32 *ptr = gCurrRenBuf->PixelData;
-        if (gCurrRenBuf->HorRes == gCurrRenBuf->PixPerScnLn) {
-            SetMem32(ptr, gCurrRenBuf->PixPerScnLn * gCurrRenBuf->VerRes * sizeof(UINT32), colour);
+        UINT32 *ptr = RenBuf->PixelData;
+        if (parallel_fill(ptr, RenBuf->HorRes, RenBuf->VerRes, RenBuf->PixPerScnLn, colour)) {
+            // filled by job scheduler
+        } else if (RenBuf->HorRes == RenBuf->PixPerScnLn) {
+            SetMem32(ptr, RenBuf->PixPerScnLn * RenBuf->VerRes * sizeof(UINT32), colour);
         } else {
-            UINT32 height = gCurrRenBuf->VerRes;
-            UINT32 wbytes = gCurrRenBuf->HorRes * sizeof(UINT32);
+            UINT32 height = RenBuf->VerRes;
+            UINT32 wbytes = RenBuf->HorRes * sizeof(UINT32);
             while (height--) {
                 SetMem32(ptr, wbytes, colour);
-                ptr += gCurrRenBuf->PixPerScnLn;
+                ptr += RenBuf->PixPerScnLn;
             }
         }
     }
-    // reset text position
-    gCurrRenBuf->TxtCfg.CurrX = gCurrRenBuf->TxtCfg.X0;
-    gCurrRenBuf->TxtCfg.CurrY = gCurrRenBuf->TxtCfg.Y0;
 }
 
 VOID ClearClipWindow(UINT32 colour)
@@ -545,12 +1132,32 @@ VOID ClearClipWindow(UINT32 colour)
         DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised\n", __func__);
         return;
     }
-    UINT32 *ptr = gCurrRenBuf->PixelData + gCurrRenBuf->ClipX0 + (gCurrRenBuf->ClipY0 * gCurrRenBuf->PixPerScnLn);
-    UINT32 height = gCurrRenBuf->ClipY1 - gCurrRenBuf->ClipY0 +1;
-    UINT32 wbytes = (gCurrRenBuf->ClipX1 - gCurrRenBuf->ClipX0 + 1) * sizeof(UINT32);
+    clear_clip_window(&gCurrCtx, colour);
+}
+
+VOID CtxClearClipWindow(GFX_CONTEXT *Ctx, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, colour=0x%08X)\n", __func__, Ctx, colour);
+
+    if (!check_context(Ctx)) {
+        return;
+    }
+    clear_clip_window(Ctx, colour);
+}
+
+STATIC VOID clear_clip_window(GFX_CONTEXT *Ctx, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, colour=0x%08X)\n", __func__, Ctx, colour);
+
+    UINT32 *ptr = Ctx->RenBuf->PixelData + Ctx->ClipX0 + (Ctx->ClipY0 * Ctx->RenBuf->PixPerScnLn);
+    UINT32 height = Ctx->ClipY1 - Ctx->ClipY0 +1;
+    UINT32 wbytes = (Ctx->ClipX1 - Ctx->ClipX0 + 1) * sizeof(UINT32);
+    if (parallel_fill(ptr, wbytes / sizeof(UINT32), height, Ctx->RenBuf->PixPerScnLn, colour)) {
+        return;
+    }
     while (height--) {
         SetMem32(ptr, wbytes, colour);
-        ptr += gCurrRenBuf->PixPerScnLn;
+        ptr += Ctx->RenBuf->PixPerScnLn;
     }
 }
 
@@ -562,17 +1169,31 @@ VOID PutPixel(INT32 x, INT32 y, UINT32 colour)
         DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised\n", __func__);
         return;
     }
+    put_pixel(&gCurrCtx, x, y, colour);
+}
+
+VOID CtxPutPixel(GFX_CONTEXT *Ctx, INT32 x, INT32 y, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x=%d, y=%d, colour=0x%08X)\n", __func__, Ctx, x, y, colour);
+
+    if (!check_context(Ctx)) {
+        return;
+    }
+    put_pixel(Ctx, x, y, colour);
+}
+
+STATIC VOID put_pixel(GFX_CONTEXT *Ctx, INT32 x, INT32 y, UINT32 colour)
+{
     // clip pixel
-    if (x < gCurrRenBuf->ClipX0 || x > gCurrRenBuf->ClipX1 || y < gCurrRenBuf->ClipY0 || y > gCurrRenBuf->ClipY1) {
+    if (x < Ctx->ClipX0 || x > Ctx->ClipX1 || y < Ctx->ClipY0 || y > Ctx->ClipY1) {
         return;
     }
     // draw pixel
-    UINT32 *ptr = gCurrRenBuf->PixelData + x + (y * gCurrRenBuf->PixPerScnLn);
+    UINT32 *ptr = Ctx->RenBuf->PixelData + x + (y * Ctx->RenBuf->PixPerScnLn);
 
     EDK2SIM_GFX_BEGIN;
     *ptr = colour;
     EDK2SIM_GFX_END;
-
 }
 
 UINT32 GetPixel(INT32 x, INT32 y)
@@ -583,35 +1204,101 @@ UINT32 GetPixel(INT32 x, INT32 y)
         DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => 0\n", __func__);
         return 0;
     }
+    return get_pixel(&gCurrCtx, x, y);
+}
+
+UINT32 CtxGetPixel(GFX_CONTEXT *Ctx, INT32 x, INT32 y)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x=%d, y=%d)\n", __func__, Ctx, x, y);
+
+    if (!check_context(Ctx)) {
+        return 0;
+    }
+    return get_pixel(Ctx, x, y);
+}
+
+STATIC UINT32 get_pixel(GFX_CONTEXT *Ctx, INT32 x, INT32 y)
+{
     // clip pixel
-    if (x < gCurrRenBuf->ClipX0 || x > gCurrRenBuf->ClipX1 || y < gCurrRenBuf->ClipY0 || y > gCurrRenBuf->ClipY1) {
+    if (x < Ctx->ClipX0 || x > Ctx->ClipX1 || y < Ctx->ClipY0 || y > Ctx->ClipY1) {
         return 0;
     }
     // draw pixel
     EDK2SIM_GFX_BEGIN;
-    UINT32 *ptr = gCurrRenBuf->PixelData + x + (y * gCurrRenBuf->PixPerScnLn);
+    UINT32 *ptr = Ctx->RenBuf->PixelData + x + (y * Ctx->RenBuf->PixPerScnLn);
     EDK2SIM_GFX_END;
     return *ptr;
 }
 
-STATIC VOID draw_hline(INT32 x, INT32 y, INT32 width, UINT32 colour)
+EFI_STATUS GetSurface(GFX_SURFACE *Surface)
 {
-    DbgPrint(DL_INFO, "%a(x=%d, y=%d, width=%d, colour=0x%08X)\n", __func__, x, y, width, colour);
+    DbgPrint(DL_INFO, "%a(Surface=0x%p)\n", __func__, Surface);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return get_surface(&gCurrCtx, Surface);
+}
+
+EFI_STATUS CtxGetSurface(GFX_CONTEXT *Ctx, GFX_SURFACE *Surface)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Surface=0x%p)\n", __func__, Ctx, Surface);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return get_surface(Ctx, Surface);
+}
+
+STATIC EFI_STATUS get_surface(GFX_CONTEXT *Ctx, GFX_SURFACE *Surface)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Surface=0x%p)\n", __func__, Ctx, Surface);
+
+    if (!Surface) {
+        DbgPrint(DL_ERROR, "%a(), Surface=NULL => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    Surface->PixelData = Ctx->RenBuf->PixelData;
+    Surface->PixPerScnLn = Ctx->RenBuf->PixPerScnLn;
+    Surface->ClipX0 = Ctx->ClipX0;
+    Surface->ClipY0 = Ctx->ClipY0;
+    Surface->ClipX1 = Ctx->ClipX1;
+    Surface->ClipY1 = Ctx->ClipY1;
+
+    return EFI_SUCCESS;
+}
+
+/*
+ * SurfaceCheckedPtr() - used by SURFACE_PIXEL_PTR() when GFX_SURFACE_CHECKS is set
+ */
+UINT32 *SurfaceCheckedPtr(CONST GFX_SURFACE *Surface, INT32 x, INT32 y)
+{
+    if (!SURFACE_IN_CLIP(Surface, x, y)) {
+        DbgPrint(DL_ERROR, "%a(x=%d, y=%d), outside clip window\n", __func__, x, y);
+        ASSERT(SURFACE_IN_CLIP(Surface, x, y));
+    }
+    return Surface->PixelData + x + (y * Surface->PixPerScnLn);
+}
+
+STATIC VOID draw_hline(GFX_CONTEXT *Ctx, INT32 x, INT32 y, INT32 width, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x=%d, y=%d, width=%d, colour=0x%08X)\n", __func__, Ctx, x, y, width, colour);
 
     // clip line
     INT32 x1 = x + width - 1;
-    if (y < gCurrRenBuf->ClipY0 || y > gCurrRenBuf->ClipY1 || x1 < gCurrRenBuf->ClipX0 || x > gCurrRenBuf->ClipX1) {
+    if (y < Ctx->ClipY0 || y > Ctx->ClipY1 || x1 < Ctx->ClipX0 || x > Ctx->ClipX1) {
         return;
     }
-    if (x < gCurrRenBuf->ClipX0) {
-        x = gCurrRenBuf->ClipX0;
-        width = (x1 - gCurrRenBuf->ClipX0 + 1);
+    if (x < Ctx->ClipX0) {
+        x = Ctx->ClipX0;
+        width = (x1 - Ctx->ClipX0 + 1);
     }
-    if (x1 > gCurrRenBuf->ClipX1) {
-        width -= (x1 - gCurrRenBuf->ClipX1);
+    if (x1 > Ctx->ClipX1) {
+        width -= (x1 - Ctx->ClipX1);
     }
     // draw line
-    UINT32* ptr = gCurrRenBuf->PixelData + x + (y * gCurrRenBuf->PixPerScnLn);
+    UINT32* ptr = Ctx->RenBuf->PixelData + x + (y * Ctx->RenBuf->PixPerScnLn);
     SetMem32(ptr, width * sizeof(UINT32), colour);
 }
 
@@ -625,7 +1312,19 @@ VOID DrawHLine(INT32 x, INT32 y, INT32 width, UINT32 colour)
         return;
     }
     EDK2SIM_GFX_BEGIN;
-    draw_hline(x, y, width, colour);
+    draw_hline(&gCurrCtx, x, y, width, colour);
+    EDK2SIM_GFX_END;
+}
+
+VOID CtxDrawHLine(GFX_CONTEXT *Ctx, INT32 x, INT32 y, INT32 width, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x=%d, y=%d, width=%d, colour=0x%08X)\n", __func__, Ctx, x, y, width, colour);
+
+    if (!check_context(Ctx)) {
+        return;
+    }
+    EDK2SIM_GFX_BEGIN;
+    draw_hline(Ctx, x, y, width, colour);
     EDK2SIM_GFX_END;
 }
 
@@ -639,6 +1338,16 @@ VOID DrawHLine2(INT32 x0, INT32 x1, INT32 y, UINT32 colour)
     DrawHLine(x0, y, ABS(x1-x0)+1, colour);
 }
 
+VOID CtxDrawHLine2(GFX_CONTEXT *Ctx, INT32 x0, INT32 x1, INT32 y, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, x0=%d, y=%d, colour=0x%08X)\n", __func__, Ctx, x0, x1, colour);
+
+    if (x1 < x0) {
+        SWAP(INT32, x0, x1);
+    }
+    CtxDrawHLine(Ctx, x0, y, ABS(x1-x0)+1, colour);
+}
+
 VOID DrawVLine(INT32 x, INT32 y, INT32 height, UINT32 colour)
 {
     DbgPrint(DL_INFO, "%a(x=%d, y=%d, height=%d, colour=0x%08X)\n", __func__, x, y, height, colour);
@@ -647,24 +1356,41 @@ VOID DrawVLine(INT32 x, INT32 y, INT32 height, UINT32 colour)
         DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => 0\n", __func__);
         return;
     }
+    draw_vline(&gCurrCtx, x, y, height, colour);
+}
+
+VOID CtxDrawVLine(GFX_CONTEXT *Ctx, INT32 x, INT32 y, INT32 height, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x=%d, y=%d, height=%d, colour=0x%08X)\n", __func__, Ctx, x, y, height, colour);
+
+    if (!check_context(Ctx)) {
+        return;
+    }
+    draw_vline(Ctx, x, y, height, colour);
+}
+
+STATIC VOID draw_vline(GFX_CONTEXT *Ctx, INT32 x, INT32 y, INT32 height, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x=%d, y=%d, height=%d, colour=0x%08X)\n", __func__, Ctx, x, y, height, colour);
+
     // clip line
     INT32 y1 = y + height - 1;
-    if (x < gCurrRenBuf->ClipX0 || x > gCurrRenBuf->ClipX1 || y1 < gCurrRenBuf->ClipY0 || y > gCurrRenBuf->ClipY1) {
+    if (x < Ctx->ClipX0 || x > Ctx->ClipX1 || y1 < Ctx->ClipY0 || y > Ctx->ClipY1) {
         return;
     }
-    if (y < gCurrRenBuf->ClipY0) {
-        y = gCurrRenBuf->ClipY0;
-        height = (y1 - gCurrRenBuf->ClipY0 + 1);
+    if (y < Ctx->ClipY0) {
+        y = Ctx->ClipY0;
+        height = (y1 - Ctx->ClipY0 + 1);
     }
-    if (y1 > gCurrRenBuf->ClipY1) {
-        height -= (y1 - gCurrRenBuf->ClipY1);
+    if (y1 > Ctx->ClipY1) {
+        height -= (y1 - Ctx->ClipY1);
     }
     // draw line
-    UINT32 *ptr = gCurrRenBuf->PixelData + x + (y * gCurrRenBuf->PixPerScnLn);
+    UINT32 *ptr = Ctx->RenBuf->PixelData + x + (y * Ctx->RenBuf->PixPerScnLn);
     EDK2SIM_GFX_BEGIN;
     while (height--) {
         *ptr = colour;
-        ptr += gCurrRenBuf->PixPerScnLn;
+        ptr += Ctx->RenBuf->PixPerScnLn;
     }
     EDK2SIM_GFX_END;
 }
@@ -677,62 +1403,175 @@ VOID DrawLine(INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour)
         DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => 0\n", __func__);
         return;
     }
-    if ( !(x0 < gCurrRenBuf->ClipX0 && x1 < gCurrRenBuf->ClipX0) && !(x0 > gCurrRenBuf->ClipX1 && x1 > gCurrRenBuf->ClipX1) ) {
-        if ( !(y0 < gCurrRenBuf->ClipY0 && y1 < gCurrRenBuf->ClipY0) && !(y0 > gCurrRenBuf->ClipY1 && y1 > gCurrRenBuf->ClipY1) ) {
-            INT32 x[2], y[2];
-            x[0] = x0;
-            y[0] = y0;
-            x[1] = x1;
-            y[1] = y1;    
-            
-            BOOLEAN visible = TRUE;
-            UINT32 i = 0;
-            while (i<2 && visible) {
-                if (y[i] > gCurrRenBuf->ClipY1) { // bottom
-                    y[i] = gCurrRenBuf->ClipY1;
-                    x[i] = x0 + (x1 - x0) * (gCurrRenBuf->ClipY1 - y0) / (y1 - y0);
-                    if (x[i] < gCurrRenBuf->ClipX0 || x[i] > gCurrRenBuf->ClipX1) {
-                        visible = FALSE;
-                    }
-                } else if (y[i] < gCurrRenBuf->ClipY0) { // top
-                    y[i] = gCurrRenBuf->ClipY0;
-                    x[i] = x0 + (x1 - x0) * (gCurrRenBuf->ClipY0 - y0) / (y1 - y0);
-                    if (x[i] < gCurrRenBuf->ClipX0 || x[i] > gCurrRenBuf->ClipX1) {
-                        visible = FALSE;
-                    }
-                } else if (x[i] > gCurrRenBuf->ClipX1) { // right
-                    x[i] = gCurrRenBuf->ClipX1;
-                    y[i] = y0 + (y1 - y0) * (gCurrRenBuf->ClipX1 - x0) / (x1 - x0);
-                    if (y[i] < gCurrRenBuf->ClipY0 || y[i] > gCurrRenBuf->ClipY1) {
-                        visible = FALSE;
-                    }
-                }  else if (x[i] < gCurrRenBuf->ClipX0) { // left
-                    x[i] = gCurrRenBuf->ClipX0;
-                    y[i] = y0 + (y1 - y0) * (gCurrRenBuf->ClipX0 - x0) / (x1 - x0);
-                    if (y[i] < gCurrRenBuf->ClipY0 || y[i] > gCurrRenBuf->ClipY1) {
-                        visible = FALSE;
-                    }
-                }
-                i++;
-            }
-            if (visible) {
-                draw_line(x[0], y[0], x[1], y[1], colour);
-            }
-        }
-    }
+    clip_line(&gCurrCtx, x0, y0, x1, y1, colour);
 }
 
-STATIC VOID draw_line(INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour)
+VOID CtxDrawLine(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour)
 {
-    DbgPrint(DL_INFO, "%a(x0=%d, y0=%d, x1=%d, y1=%d, colour=0x%08X)\n", __func__, x0, y0, x1, y1, colour);
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, colour);
 
-    INT32 dx = ABS(x1 - x0);
-    INT32 sx = x0 < x1 ? 1 : -1;
-    INT32 dy = -ABS(y1 - y0);
-    INT32 sy = y0 < y1 ? 1 : -1;
-    INT32 error = dx + dy;
+    if (!check_context(Ctx)) {
+        return;
+    }
+    clip_line(Ctx, x0, y0, x1, y1, colour);
+}
 
-    UINT32 *ptr = gCurrRenBuf->PixelData + x0 + (y0 * gCurrRenBuf->PixPerScnLn);
+EFI_STATUS DrawPolyline(CONST POINT *Points, UINTN Count, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Points=0x%p, Count=%u, colour=0x%08X)\n", __func__, Points, Count, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_lines(&gCurrCtx, Points, Count, TRUE, colour);
+}
+
+EFI_STATUS CtxDrawPolyline(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Points=0x%p, Count=%u, colour=0x%08X)\n", __func__, Ctx, Points, Count, colour);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_lines(Ctx, Points, Count, TRUE, colour);
+}
+
+EFI_STATUS DrawLines(CONST POINT *Points, UINTN Count, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Points=0x%p, Count=%u, colour=0x%08X)\n", __func__, Points, Count, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_lines(&gCurrCtx, Points, Count, FALSE, colour);
+}
+
+EFI_STATUS CtxDrawLines(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Points=0x%p, Count=%u, colour=0x%08X)\n", __func__, Ctx, Points, Count, colour);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_lines(Ctx, Points, Count, FALSE, colour);
+}
+
+/*
+ * draw_lines() - connected polyline (Connected) or separate lines from point pairs
+ *
+ * Points are checked up front so a bad point draws nothing, then each
+ * segment goes straight to clip_line().
+ */
+STATIC EFI_STATUS draw_lines(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, BOOLEAN Connected, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Points=0x%p, Count=%u, Connected=%u, colour=0x%08X)\n", __func__, Ctx, Points, Count, Connected, colour);
+
+    if ((!Points && Count) || (!Connected && (Count & 1))) {
+        DbgPrint(DL_ERROR, "%a(), invalid parameter => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    for (UINTN i = 0; i < Count; i++) {
+        if (ABS(Points[i].X) > LINE_MAX_ORD || ABS(Points[i].Y) > LINE_MAX_ORD) {
+            DbgPrint(DL_ERROR, "%a(), Points[%u] out of range => EFI_INVALID_PARAMETER\n", __func__, i);
+            return EFI_INVALID_PARAMETER;
+        }
+    }
+    UINTN Step = Connected ? 1 : 2;
+    for (UINTN i = 0; i + 1 < Count; i += Step) {
+        clip_line(Ctx, Points[i].X, Points[i].Y, Points[i + 1].X, Points[i + 1].Y, colour);
+    }
+    return EFI_SUCCESS;
+}
+
+/*
+ * clip_line() - clip line to clip window and draw visible part
+ *
+ * Pixel k along the major axis of a line with major length L and minor
+ * length l is floor((2kl + L) / 2L) along the minor axis, as draw_line()
+ * steps it. Each clip edge bounds k (Liang-Barsky with the pixel index as
+ * parameter) and the walk starts at the first visible pixel with the error
+ * term it would have there, so a clipped line is exactly the pixels of the
+ * whole line that are inside the clip window.
+ */
+STATIC VOID clip_line(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, colour);
+
+    if (ABS(x0) > LINE_MAX_ORD || ABS(y0) > LINE_MAX_ORD || ABS(x1) > LINE_MAX_ORD || ABS(y1) > LINE_MAX_ORD) {
+        DbgPrint(DL_ERROR, "%a(), coordinates out of range\n", __func__);
+        return;
+    }
+    INT64 dx = ABS(x1 - x0);
+    INT64 dy = ABS(y1 - y0);
+    BOOLEAN XMajor = (dx >= dy);
+    INT64 L = XMajor ? dx : dy;
+    INT64 l = XMajor ? dy : dx;
+    INT64 p0 = XMajor ? x0 : y0;
+    INT64 q0 = XMajor ? y0 : x0;
+    BOOLEAN pInc = XMajor ? (x1 >= x0) : (y1 >= y0);
+    BOOLEAN qInc = XMajor ? (y1 >= y0) : (x1 >= x0);
+    INT64 P0 = XMajor ? Ctx->ClipX0 : Ctx->ClipY0;
+    INT64 P1 = XMajor ? Ctx->ClipX1 : Ctx->ClipY1;
+    INT64 Q0 = XMajor ? Ctx->ClipY0 : Ctx->ClipX0;
+    INT64 Q1 = XMajor ? Ctx->ClipY1 : Ctx->ClipX1;
+
+    // major axis edges bound k directly
+    INT64 k0 = MAX(0, pInc ? P0 - p0 : p0 - P1);
+    INT64 k1 = MIN(L, pInc ? P1 - p0 : p0 - P0);
+    // minor axis edges bound the minor offset, turned into k by inverting the step rule
+    INT64 Lo = qInc ? Q0 - q0 : q0 - Q1;
+    INT64 Hi = qInc ? Q1 - q0 : q0 - Q0;
+    if (k0 > k1 || Lo > l || Hi < 0) {
+        return;
+    }
+    if (Lo > 0) {
+        k0 = MAX(k0, DivS64x64Remainder(2 * L * Lo - L + 2 * l - 1, 2 * l, NULL));
+    }
+    if (Hi < l) {
+        k1 = MIN(k1, DivS64x64Remainder(2 * L * (Hi + 1) - L + 2 * l - 1, 2 * l, NULL) - 1);
+    }
+    if (k0 > k1) {
+        return;
+    }
+    INT64 m0 = L ? DivS64x64Remainder(2 * k0 * l + L, 2 * L, NULL) : 0;
+    INT64 m1 = L ? DivS64x64Remainder(2 * k1 * l + L, 2 * L, NULL) : 0;
+    INT64 sx = (x1 >= x0) ? 1 : -1;
+    INT64 sy = (y1 >= y0) ? 1 : -1;
+    // steps taken along x and y to reach pixel k0, for draw_line()'s error term
+    INT64 Kx = XMajor ? k0 : m0;
+    INT64 Ky = XMajor ? m0 : k0;
+    INT32 error = (INT32)(dx - dy - Kx * dy + Ky * dx);
+
+    if (XMajor) {
+        draw_line(Ctx, (INT32)(x0 + sx * k0), (INT32)(y0 + sy * m0), (INT32)(x0 + sx * k1), (INT32)(y0 + sy * m1), (INT32)dx, (INT32)-dy, error, colour);
+    } else {
+        draw_line(Ctx, (INT32)(x0 + sx * m0), (INT32)(y0 + sy * k0), (INT32)(x0 + sx * m1), (INT32)(y0 + sy * k1), (INT32)dx, (INT32)-dy, error, colour);
+    }
+}
+
+// Lines at least this many times wider than tall are drawn as horizontal runs
+#define LINE_RUN_MIN    16
+
+/*
+ * draw_line() - Bresenham walk from (x0, y0) to (x1, y1), both on the line with lengths dx and -dy
+ *
+ * error is the error term at (x0, y0), dx + dy at the start of the line.
+ */
+STATIC VOID draw_line(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 dx, INT32 dy, INT32 error, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, dx=%d, dy=%d, error=%d, colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, dx, dy, error, colour);
+
+    INT32 sx = x0 < x1 ? 1 : -1;
+    INT32 sy = y0 < y1 ? 1 : -1;
+
+    if (dx / LINE_RUN_MIN >= -dy) {
+        draw_line_runs(Ctx, x0, y0, x1, y1, dx, -dy, error, colour);
+        return;
+    }
+
+    UINT32 *ptr = Ctx->RenBuf->PixelData + x0 + (y0 * Ctx->RenBuf->PixPerScnLn);
 
     EDK2SIM_GFX_BEGIN;
     while (TRUE) {
@@ -754,12 +1593,408 @@ STATIC VOID draw_line(INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour)
             if (y0 == y1) break;
             error += dx;
             y0 += sy;
-            ptr += (sy * (INT32)gCurrRenBuf->PixPerScnLn);
+            ptr += (sy * (INT32)Ctx->RenBuf->PixPerScnLn);
+        }
+    }
+    EDK2SIM_GFX_END;
+}
+
+/*
+ * draw_line_runs() - run-slice line for mostly horizontal lines (dx >= dy), same pixels as draw_line()
+ *
+ * draw_line() steps y once 2*error <= dx, error falling by dy per pixel, so a
+ * row has ceil((2*error - dx) / 2dy) + 1 pixels. Written as N = Q*2dy - R that
+ * length only needs Q, and moving to the next row (N += 2dx - (Q+1)*2dy) takes
+ * Q and R to a new pair from 2dx = A*2dy + B with a compare, so runs are sized
+ * up front without a division or test per pixel.
+ */
+STATIC VOID draw_line_runs(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 dx, INT32 dy, INT32 error, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, dx=%d, dy=%d, error=%d, colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, dx, dy, error, colour);
+
+    INT32 sx = x0 < x1 ? 1 : -1;
+    INT32 Rows = ABS(y1 - y0);
+    INT32 PixPerScnLn = Ctx->RenBuf->PixPerScnLn;
+    UINT32 *ptr = Ctx->RenBuf->PixelData + x0 + (y0 * PixPerScnLn);
+    INT32 Remaining = ABS(x1 - x0) + 1;
+
+    EDK2SIM_GFX_BEGIN;
+    if (Rows) {
+        INT32 Step = (y0 < y1) ? PixPerScnLn : -PixPerScnLn;
+        INT32 D = 2 * dy;
+        INT32 A = (2 * dx) / D;
+        INT32 B = (2 * dx) % D;
+        // first row, possibly part way along
+        INT32 N = 2 * error - dx;
+        INT32 Q = (N > 0) ? (N + D - 1) / D : 0;
+        INT32 R = Q * D - N;
+        for (INT32 Row = 0; Row < Rows; Row++) {
+            INT32 Run = Q + 1;
+            SetMem32((sx > 0) ? ptr : ptr - (Run - 1), Run * sizeof(UINT32), colour);
+            ptr += (sx * Run) + Step;
+            Remaining -= Run;
+            if (B > R) {
+                Q = A;
+                R = D - (B - R);
+            } else {
+                Q = A - 1;
+                R -= B;
+            }
+        }
+    }
+    // last row
+    SetMem32((sx > 0) ? ptr : ptr - (Remaining - 1), Remaining * sizeof(UINT32), colour);
+    EDK2SIM_GFX_END;
+}
+
+/*
+ * DrawLineAA()
+ */
+
+VOID DrawLineAA(INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(x0=%d, y0=%d, x1=%d, y1=%d, colour=0x%08X)\n", __func__, x0, y0, x1, y1, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => 0\n", __func__);
+        return;
+    }
+    draw_line_aa(&gCurrCtx, x0, y0, x1, y1, colour);
+}
+
+VOID CtxDrawLineAA(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, colour);
+
+    if (!check_context(Ctx)) {
+        return;
+    }
+    draw_line_aa(Ctx, x0, y0, x1, y1, colour);
+}
+
+/*
+ * draw_line_aa() - Xiaolin Wu anti-aliased line, end points at pixel centres
+ *
+ * Each major axis step covers the two pixels either side of the line by
+ * the fraction of the minor axis error, kept as 8 bits. Horizontal,
+ * vertical and diagonal lines have no partial pixels so go to clip_line().
+ */
+STATIC VOID draw_line_aa(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, colour);
+
+    if (ABS(x0) > LINE_MAX_ORD || ABS(y0) > LINE_MAX_ORD || ABS(x1) > LINE_MAX_ORD || ABS(y1) > LINE_MAX_ORD) {
+        DbgPrint(DL_ERROR, "%a(), coordinates out of range\n", __func__);
+        return;
+    }
+    INT32 dx = ABS(x1 - x0);
+    INT32 dy = ABS(y1 - y0);
+    if (dx == 0 || dy == 0 || dx == dy) {
+        clip_line(Ctx, x0, y0, x1, y1, colour);
+        return;
+    }
+    AA_LINE Line;
+    Line.X0 = x0;
+    Line.Y0 = y0;
+    if (dx > dy) {
+        Line.Length = dx;
+        Line.Mx = (x1 > x0) ? 1 : -1;
+        Line.My = 0;
+        Line.Nx = 0;
+        Line.Ny = (y1 > y0) ? 1 : -1;
+    } else {
+        Line.Length = dy;
+        Line.Mx = 0;
+        Line.My = (y1 > y0) ? 1 : -1;
+        Line.Nx = (x1 > x0) ? 1 : -1;
+        Line.Ny = 0;
+    }
+    UINT64 Rem;
+    Line.Rise = MIN(dx, dy);
+    Line.WStep = (UINT32)DivU64x64Remainder(LShiftU64(Line.Rise, 8), Line.Length, &Rem);
+    Line.WRem = (UINT32)Rem;
+    if (draw_full_line_aa(Ctx, &Line, x1, y1, colour)) {
+        // whole line was drawn
+        return;
+    }
+    draw_part_line_aa(Ctx, &Line, colour);
+}
+
+/*
+ * draw_full_line_aa() - return TRUE if line drawn, only when both end points are inside the clip window
+ *
+ * Both pixels of every step are then within the end points' bounding box,
+ * so the inner loop is pointer steps and blends without clip tests.
+ */
+STATIC BOOLEAN draw_full_line_aa(GFX_CONTEXT *Ctx, CONST AA_LINE *Line, INT32 x1, INT32 y1, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Line=0x%p, x1=%d, y1=%d, colour=0x%08X)\n", __func__, Ctx, Line, x1, y1, colour);
+
+    if (Line->X0 < Ctx->ClipX0 || Line->X0 > Ctx->ClipX1 || Line->Y0 < Ctx->ClipY0 || Line->Y0 > Ctx->ClipY1 ||
+        x1 < Ctx->ClipX0 || x1 > Ctx->ClipX1 || y1 < Ctx->ClipY0 || y1 > Ctx->ClipY1) {
+        // line is clipped so exit
+        return FALSE;
+    }
+    INT32 PixPerScnLn = Ctx->RenBuf->PixPerScnLn;
+    INT32 Major = Line->Mx + (Line->My * PixPerScnLn);
+    INT32 Minor = Line->Nx + (Line->Ny * PixPerScnLn);
+    UINT32 *ptr = Ctx->RenBuf->PixelData + Line->X0 + (Line->Y0 * PixPerScnLn);
+    UINT32 w = 0;
+    UINT32 r = 0;
+
+    EDK2SIM_GFX_BEGIN;
+    *ptr = colour;
+    for (INT32 k = Line->Length - 1; k > 0; k--) {
+        w = step_line_aa(Line, w, &r);
+        if (w > 0xFF) {
+            w -= 0x100;
+            ptr += Minor;
+        }
+        ptr += Major;
+        ptr[0] = lerp_colour(ptr[0], colour, 256 - w);
+        ptr[Minor] = lerp_colour(ptr[Minor], colour, w);
+    }
+    *(Ctx->RenBuf->PixelData + x1 + (y1 * PixPerScnLn)) = colour;
+    EDK2SIM_GFX_END;
+    return TRUE;
+}
+
+/*
+ * draw_part_line_aa() - clipped line, steps limited to the clip window's extent along the major axis
+ */
+STATIC VOID draw_part_line_aa(GFX_CONTEXT *Ctx, CONST AA_LINE *Line, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Line=0x%p, colour=0x%08X)\n", __func__, Ctx, Line, colour);
+
+    // major axis steps that can touch the clip window
+    INT64 k0 = 0;
+    INT64 k1 = Line->Length;
+    if (Line->Mx) {
+        k0 = MAX(k0, (Line->Mx > 0) ? Ctx->ClipX0 - Line->X0 : Line->X0 - Ctx->ClipX1);
+        k1 = MIN(k1, (Line->Mx > 0) ? Ctx->ClipX1 - Line->X0 : Line->X0 - Ctx->ClipX0);
+    } else {
+        k0 = MAX(k0, (Line->My > 0) ? Ctx->ClipY0 - Line->Y0 : Line->Y0 - Ctx->ClipY1);
+        k1 = MIN(k1, (Line->My > 0) ? Ctx->ClipY1 - Line->Y0 : Line->Y0 - Ctx->ClipY0);
+    }
+    if (k0 > k1) {
+        return;
+    }
+    INT32 PixPerScnLn = Ctx->RenBuf->PixPerScnLn;
+
+    // seed the minor offset and weight at k0 exactly, then step them
+    UINT64 Rem;
+    INT32 n = (INT32)DivU64x64Remainder(MultU64x32(k0, Line->Rise), Line->Length, &Rem);
+    UINT32 w = (UINT32)DivU64x64Remainder(LShiftU64(Rem, 8), Line->Length, &Rem);
+    UINT32 r = (UINT32)Rem;
+    INT32 x = Line->X0 + ((INT32)k0 * Line->Mx) + (n * Line->Nx);
+    INT32 y = Line->Y0 + ((INT32)k0 * Line->My) + (n * Line->Ny);
+
+    EDK2SIM_GFX_BEGIN;
+    for (INT64 k = k0; k <= k1; k++) {
+        if (k > k0) {
+            w = step_line_aa(Line, w, &r);
+            if (w > 0xFF) {
+                w -= 0x100;
+                x += Line->Nx;
+                y += Line->Ny;
+            }
+            x += Line->Mx;
+            y += Line->My;
+        }
+        if (k == 0 || k == Line->Length) {
+            // end points are exact
+            if (x >= Ctx->ClipX0 && x <= Ctx->ClipX1 && y >= Ctx->ClipY0 && y <= Ctx->ClipY1) {
+                *(Ctx->RenBuf->PixelData + x + (y * PixPerScnLn)) = colour;
+            }
+            continue;
+        }
+        if (x >= Ctx->ClipX0 && x <= Ctx->ClipX1 && y >= Ctx->ClipY0 && y <= Ctx->ClipY1) {
+            UINT32 *ptr = Ctx->RenBuf->PixelData + x + (y * PixPerScnLn);
+            *ptr = lerp_colour(*ptr, colour, 256 - w);
+        }
+        INT32 xn = x + Line->Nx;
+        INT32 yn = y + Line->Ny;
+        if (xn >= Ctx->ClipX0 && xn <= Ctx->ClipX1 && yn >= Ctx->ClipY0 && yn <= Ctx->ClipY1) {
+            UINT32 *ptr = Ctx->RenBuf->PixelData + xn + (yn * PixPerScnLn);
+            *ptr = lerp_colour(*ptr, colour, w);
         }
     }
     EDK2SIM_GFX_END;
 }
 
+/*
+ * step_line_aa() - advance the weight one major step, over 0xFF means the minor axis steps too
+ *
+ * The weight is 256*(k*Rise mod Length) / Length kept as quotient and
+ * remainder, so the position and weight are exact at any length.
+ */
+STATIC UINT32 step_line_aa(CONST AA_LINE *Line, UINT32 w, UINT32 *r)
+{
+    w += Line->WStep;
+    *r += Line->WRem;
+    if (*r >= (UINT32)Line->Length) {
+        *r -= Line->Length;
+        w++;
+    }
+    return w;
+}
+
+/*
+ * DrawBezier()
+ */
+
+EFI_STATUS DrawBezier(CONST POINT *Points, UINTN Count, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Points=0x%p, Count=%u, colour=0x%08X)\n", __func__, Points, Count, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_bezier(&gCurrCtx, Points, Count, FALSE, colour);
+}
+
+EFI_STATUS CtxDrawBezier(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Points=0x%p, Count=%u, colour=0x%08X)\n", __func__, Ctx, Points, Count, colour);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_bezier(Ctx, Points, Count, FALSE, colour);
+}
+
+EFI_STATUS DrawBezierAA(CONST POINT *Points, UINTN Count, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Points=0x%p, Count=%u, colour=0x%08X)\n", __func__, Points, Count, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_bezier(&gCurrCtx, Points, Count, TRUE, colour);
+}
+
+EFI_STATUS CtxDrawBezierAA(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Points=0x%p, Count=%u, colour=0x%08X)\n", __func__, Ctx, Points, Count, colour);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_bezier(Ctx, Points, Count, TRUE, colour);
+}
+
+/*
+ * draw_bezier() - quadratic (Count 3) or cubic (Count 4) Bezier curve as line segments
+ *
+ * The curve is a + bt + ct^2 + dt^3 and is stepped in 2^s equal steps of t
+ * by forward differencing. With BEZIER_FRAC_BITS >= 3 * BEZIER_MAX_SHIFT
+ * fraction bits every difference is exact, so the points are the curve's
+ * own points rounded to pixels and the last one is the end point. The step
+ * count is the smallest that keeps each segment within 1/4 pixel of the
+ * curve, from the bound h^2 * max|B''| / 8 on a chord's error, and is never
+ * more than the control points' extent, so the segment count follows the
+ * curve's size and the drawn pixels follow its length.
+ */
+STATIC EFI_STATUS draw_bezier(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, BOOLEAN AntiAlias, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Points=0x%p, Count=%u, AntiAlias=%u, colour=0x%08X)\n", __func__, Ctx, Points, Count, AntiAlias, colour);
+
+    if (!Points || (Count != 3 && Count != 4)) {
+        DbgPrint(DL_ERROR, "%a(), invalid parameter => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    INT64 MinX = Points[0].X, MaxX = Points[0].X;
+    INT64 MinY = Points[0].Y, MaxY = Points[0].Y;
+    for (UINTN i = 0; i < Count; i++) {
+        if (ABS(Points[i].X) > LINE_MAX_ORD || ABS(Points[i].Y) > LINE_MAX_ORD) {
+            DbgPrint(DL_ERROR, "%a(), Points[%u] out of range => EFI_INVALID_PARAMETER\n", __func__, i);
+            return EFI_INVALID_PARAMETER;
+        }
+        MinX = MIN(MinX, Points[i].X);
+        MaxX = MAX(MaxX, Points[i].X);
+        MinY = MIN(MinY, Points[i].Y);
+        MaxY = MAX(MaxY, Points[i].Y);
+    }
+    // the curve is inside its control points' hull, anti-aliased lines reach one pixel beyond
+    if (MaxX < Ctx->ClipX0 - 1 || MinX > Ctx->ClipX1 + 1 || MaxY < Ctx->ClipY0 - 1 || MinY > Ctx->ClipY1 + 1) {
+        return EFI_SUCCESS;
+    }
+
+    // coefficients of t^3, t^2 and t, and the largest second difference of the control points
+    INT64 Ax, Ay, Bx, By, Cx, Cy;
+    INT64 Ex = Points[0].X - 2 * (INT64)Points[1].X + Points[2].X;
+    INT64 Ey = Points[0].Y - 2 * (INT64)Points[1].Y + Points[2].Y;
+    UINT64 E = (UINT64)(Ex * Ex + Ey * Ey);
+    UINT64 Need;
+    if (Count == 3) {
+        Ax = 0;
+        Ay = 0;
+        Bx = Ex;
+        By = Ey;
+        Cx = 2 * ((INT64)Points[1].X - Points[0].X);
+        Cy = 2 * ((INT64)Points[1].Y - Points[0].Y);
+        // |B''| = 2|E|, so N^2 >= |E| keeps the error within 1/4 pixel
+        Need = isqrt64(E) + 1;
+    } else {
+        INT64 Fx = Points[1].X - 2 * (INT64)Points[2].X + Points[3].X;
+        INT64 Fy = Points[1].Y - 2 * (INT64)Points[2].Y + Points[3].Y;
+        E = MAX(E, (UINT64)(Fx * Fx + Fy * Fy));
+        Ax = Fx - Ex;
+        Ay = Fy - Ey;
+        Bx = 3 * Ex;
+        By = 3 * Ey;
+        Cx = 3 * ((INT64)Points[1].X - Points[0].X);
+        Cy = 3 * ((INT64)Points[1].Y - Points[0].Y);
+        // |B''| <= 6 * max|E|, so N^2 >= 3 * max|E|
+        Need = 3 * (isqrt64(E) + 1);
+    }
+    INT64 Extent = MAX(MaxX - MinX, MaxY - MinY);
+    UINTN s = 0;
+    while (s < BEZIER_MAX_SHIFT && ((INT64)1 << s) < Extent && ((UINT64)1 << (2 * s)) < Need) {
+        s++;
+    }
+
+    // position and forward differences, BEZIER_FRAC_BITS fixed point
+    INT64 h1 = (INT64)1 << (BEZIER_FRAC_BITS - s);
+    INT64 h2 = (INT64)1 << (BEZIER_FRAC_BITS - 2 * s);
+    INT64 h3 = (INT64)1 << (BEZIER_FRAC_BITS - 3 * s);
+    INT64 X = (INT64)Points[0].X * ((INT64)1 << BEZIER_FRAC_BITS);
+    INT64 Y = (INT64)Points[0].Y * ((INT64)1 << BEZIER_FRAC_BITS);
+    INT64 X1 = Ax * h3 + Bx * h2 + Cx * h1;
+    INT64 Y1 = Ay * h3 + By * h2 + Cy * h1;
+    INT64 X2 = 6 * Ax * h3 + 2 * Bx * h2;
+    INT64 Y2 = 6 * Ay * h3 + 2 * By * h2;
+    INT64 X3 = 6 * Ax * h3;
+    INT64 Y3 = 6 * Ay * h3;
+    INT64 Half = (INT64)1 << (BEZIER_FRAC_BITS - 1);
+    INT32 px = Points[0].X;
+    INT32 py = Points[0].Y;
+
+    for (UINTN k = (UINTN)1 << s; k > 0; k--) {
+        X += X1;
+        Y += Y1;
+        X1 += X2;
+        Y1 += Y2;
+        X2 += X3;
+        Y2 += Y3;
+        INT32 x = (INT32)ARShiftU64(X + Half, BEZIER_FRAC_BITS);
+        INT32 y = (INT32)ARShiftU64(Y + Half, BEZIER_FRAC_BITS);
+        if (x == px && y == py && k > 1) {
+            continue;
+        }
+        if (AntiAlias) {
+            draw_line_aa(Ctx, px, py, x, y, colour);
+        } else {
+            clip_line(Ctx, px, py, x, y, colour);
+        }
+        px = x;
+        py = y;
+    }
+    return EFI_SUCCESS;
+}
+
 VOID DrawTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 colour)
 {
     DbgPrint(DL_INFO, "%a(x0=%d, y0=%d, x1=%d, y1=%d, x2=%d, y2=%d colour=0x%08X)\n", __func__, x0, y0, x1, y1, x2, y2, colour);
@@ -768,6 +2003,23 @@ VOID DrawTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UI
         DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => 0\n", __func__);
         return;
     }
+    draw_triangle(&gCurrCtx, x0, y0, x1, y1, x2, y2, colour);
+}
+
+VOID CtxDrawTriangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, x2=%d, y2=%d colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, x2, y2, colour);
+
+    if (!check_context(Ctx)) {
+        return;
+    }
+    draw_triangle(Ctx, x0, y0, x1, y1, x2, y2, colour);
+}
+
+STATIC VOID draw_triangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, x2=%d, y2=%d colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, x2, y2, colour);
+
     // sort the vertices, y0 < y1 < y2
     // same order as for a filled triangle
     if (y0 > y1) {
@@ -782,13 +2034,11 @@ VOID DrawTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UI
         SWAP(INT32, x1, x2);
         SWAP(INT32, y1, y2);
     }
-    DrawLine(x0, y0, x1, y1, colour);
-    DrawLine(x1, y1, x2, y2, colour);
-    DrawLine(x2, y2, x0, y0, colour);
+    clip_line(Ctx, x0, y0, x1, y1, colour);
+    clip_line(Ctx, x1, y1, x2, y2, colour);
+    clip_line(Ctx, x2, y2, x0, y0, colour);
 }
 
-// Fill a triangle - Bresenham method
-// TODO: full clipping before rendering
 VOID DrawFillTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 colour)
 {
     DbgPrint(DL_INFO, "%a(x0=%d, y0=%d, x1=%d, y1=%d, x2=%d, y2=%d colour=0x%08X)\n", __func__, x0, y0, x1, y1, x2, y2, colour);
@@ -797,6 +2047,100 @@ VOID DrawFillTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2
         DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => 0\n", __func__);
         return;
     }
+    draw_fill_triangle(&gCurrCtx, x0, y0, x1, y1, x2, y2, colour);
+}
+
+VOID CtxDrawFillTriangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, x2=%d, y2=%d colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, x2, y2, colour);
+
+    if (!check_context(Ctx)) {
+        return;
+    }
+    draw_fill_triangle(Ctx, x0, y0, x1, y1, x2, y2, colour);
+}
+
+// Triangle edge walker, gives x-ord range of the Bresenham line [xa,ya] -> [xb,yb]
+// (ya <= yb) on successive rows. Pixels match those stepped by clip_line() so fills
+// still meet outlines, but any row can be started at without walking to it.
+typedef struct {
+    INT64   Xa;
+    INT64   Sx;     // x direction
+    INT64   Dx;     // ABS(xb - xa)
+    BOOLEAN XMajor;
+    INT64   Prev;   // q of previous row
+    INT64   Q;      // floor((2Dx.j + C) / D) for current row j
+    INT64   R;
+    INT64   Dq;     // per row quotient/remainder increment
+    INT64   Dr;
+    INT64   D;
+} TRI_EDGE;
+
+/*
+ * edge_init() - set up edge walker starting at row y
+ */
+STATIC VOID edge_init(TRI_EDGE *Edge, INT32 xa, INT32 ya, INT32 xb, INT32 yb, INT32 y)
+{
+    INT64 dx = ABS((INT64)xb - xa);
+    INT64 dy = (INT64)yb - ya;
+    INT64 j = (INT64)y - ya;
+
+    Edge->Xa = xa;
+    Edge->Sx = (xa < xb) ? 1 : -1;
+    Edge->Dx = dx;
+    if (dy == 0) {
+        // horizontal, single row
+        Edge->XMajor = TRUE;
+        Edge->Prev = -1;
+        Edge->Q = dx;
+        Edge->D = 1;
+        Edge->R = Edge->Dq = Edge->Dr = 0;
+        return;
+    }
+    // x-major rows end at floor((2dx.j + dx - 1) / 2dy), and start one after previous row
+    // y-major rows hold the single pixel floor((2dx.j + dy) / 2dy)
+    Edge->XMajor = (dx >= dy);
+    INT64 C = Edge->XMajor ? dx - 1 : dy;
+    Edge->D = 2 * dy;
+    Edge->Dq = DivS64x64Remainder(2 * dx, Edge->D, &Edge->Dr);
+    Edge->Prev = (j > 0) ? DivS64x64Remainder(2 * dx * (j - 1) + C, Edge->D, NULL) : -1;
+    Edge->Q = DivS64x64Remainder(2 * dx * j + C, Edge->D, &Edge->R);
+}
+
+/*
+ * edge_step() - get x-ord range on current row and move to next row
+ */
+STATIC VOID edge_step(TRI_EDGE *Edge, INT32 *xl, INT32 *xr)
+{
+    INT64 lo, hi;
+    if (Edge->XMajor) {
+        lo = Edge->Prev + 1;
+        hi = (Edge->Q < Edge->Dx) ? Edge->Q : Edge->Dx;
+    } else {
+        lo = hi = Edge->Q;
+    }
+    if (Edge->Sx > 0) {
+        *xl = (INT32)(Edge->Xa + lo);
+        *xr = (INT32)(Edge->Xa + hi);
+    } else {
+        *xl = (INT32)(Edge->Xa - hi);
+        *xr = (INT32)(Edge->Xa - lo);
+    }
+    Edge->Prev = Edge->Q;
+    Edge->Q += Edge->Dq;
+    Edge->R += Edge->Dr;
+    if (Edge->R >= Edge->D) {
+        Edge->R -= Edge->D;
+        Edge->Q++;
+    }
+}
+
+// Fill a triangle - Bresenham method
+// Edges are started at the first visible row so off screen parts cost nothing
+STATIC VOID draw_fill_triangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, x2=%d, y2=%d colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, x2, y2, colour);
+
     // sort the vertices, y0 < y1 < y2
     if (y0 > y1) {
         SWAP(INT32, x0, x1);
@@ -811,421 +2155,1725 @@ VOID DrawFillTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2
         SWAP(INT32, y1, y2);
     }
     // clip y
-    if (y2 < gCurrRenBuf->ClipY0 || y0 > gCurrRenBuf->ClipY1) {
+    if (y2 < Ctx->ClipY0 || y0 > Ctx->ClipY1) {
+        return;
+    }
+    // clip x
+    if ((x0 < Ctx->ClipX0 && x1 < Ctx->ClipX0 && x2 < Ctx->ClipX0) ||
+        (x0 > Ctx->ClipX1 && x1 > Ctx->ClipX1 && x2 > Ctx->ClipX1)) {
         return;
     }
+    INT32 yt = (y0 < Ctx->ClipY0) ? Ctx->ClipY0 : y0;
+    INT32 yb = (y2 > Ctx->ClipY1) ? Ctx->ClipY1 : y2;
 
     // A [x0,y0] -> [x2,y2]
-    INT32 Ax = x0;
-    INT32 Ay = y0;
-    INT32 Adx = ABS(x2 - x0);
-    INT32 Asx = x0 < x2 ? 1 : -1;
-    INT32 Ady = -ABS(y2 - y0);
-    INT32 Asy = y0 < y2 ? 1 : -1;
-    INT32 Aerror = Adx + Ady;
-
-    INT32 Bx, By, Btargetx, Btargety, Bdx, Bsx, Bdy, Bsy, Berror;
-    if (y0 != y1) {
-        // B [x0,y0] -> [x1,y1]
-        Bx = x0;
-        By = y0;
-        Btargetx = x1;
-        Btargety = y1;
-        Bdx = ABS(Btargetx - Bx);
-        Bsx = Bx < Btargetx ? 1 : -1;
-        Bdy = -ABS(Btargety - By);
-        Bsy = By < Btargety ? 1 : -1;
-        Berror = Bdx + Bdy;
+    TRI_EDGE A;
+    edge_init(&A, x0, y0, x2, y2, yt);
+    // B [x0,y0] -> [x1,y1] to row y1, then [x1,y1] -> [x2,y2] (from the start if flat top)
+    TRI_EDGE B;
+    BOOLEAN Bupper = (yt < y1 || (yt == y1 && y0 != y1));
+    if (Bupper) {
+        edge_init(&B, x0, y0, x1, y1, yt);
     } else {
-        // flat top
-        // B [x1,y1] -> [x2,y2]
-        Bx = x1;
-        By = y1;
-        Btargetx = x2;
-        Btargety = y2;
-        Bdx = ABS(Btargetx - Bx);
-        Bsx = Bx < Btargetx ? 1 : -1;
-        Bdy = -ABS(Btargety - By);
-        Bsy = By < Btargety ? 1 : -1;
-        Berror = Bdx + Bdy;
-    }
-
-    BOOLEAN Acomplete = FALSE;
-    BOOLEAN Bcomplete = FALSE;
+        edge_init(&B, x1, y1, x2, y2, yt);
+    }
 
     EDK2SIM_GFX_BEGIN;
-    while (!Acomplete && !Bcomplete) {
-
-        INT32 currentY = Ay; // current horizontial line y-ord
-
-        if (currentY > gCurrRenBuf->ClipY1) break; // clipped
-
-        // Segment A
-        INT32 Aminx = Ax;
-        INT32 Amaxx = Ax;
-        BOOLEAN Aychange = FALSE;
-        BOOLEAN Axchange = FALSE;
-        while (!Aychange) {			
-            if (Axchange) {	// if x-ord change then update x-ord min/max
-                if (Ax > Amaxx) {
-                    Amaxx = Ax;
-                } else {
-                    Aminx = Ax;
-                }
-            }
-            // [x,y] point on A line
-            if (Ax == x2 && Ay == y2) {	// check if reached end
-                Acomplete = TRUE;
-                break;
+    UINT32 *ptr = Ctx->RenBuf->PixelData + (yt * Ctx->RenBuf->PixPerScnLn);
+    for (INT32 y = yt; y <= yb; y++) {
+        if (Bupper && y > y1) {
+            // switch to next B segment
+            edge_init(&B, x1, y1, x2, y2, y);
+            Bupper = FALSE;
+        }
+        INT32 Axl, Axr, Bxl, Bxr;
+        edge_step(&A, &Axl, &Axr);
+        edge_step(&B, &Bxl, &Bxr);
+        // draw horizontial line A to B
+        INT32 xl = (Axl < Bxl) ? Axl : Bxl;
+        INT32 xr = (Axr > Bxr) ? Axr : Bxr;
+        if (xr >= Ctx->ClipX0 && xl <= Ctx->ClipX1) {
+            if (xl < Ctx->ClipX0) {
+                xl = Ctx->ClipX0;
             }
-            INT32 Ae2 = 2 * Aerror;
-            if (Ae2 >= Ady) {
-                // update x-ord				
-                if (Ax == x2) {	// check if reached end
-                    Acomplete = TRUE;
-                    break;
-                }
-                Aerror += Ady;
-                Ax += Asx;
-                Axchange = TRUE;
+            if (xr > Ctx->ClipX1) {
+                xr = Ctx->ClipX1;
             }
-            if (Ae2 <= Adx) {
-                // update y-ord
-                if (Ay == y2) {  // check if reached end
-                    Acomplete = TRUE;
-                    break;
-                }
-                Aerror += Adx;
-                Ay += Asy;
-                Aychange = TRUE;
-            }
-        }
-
-        // Segment B (2 parts)
-        INT32 Bminx = Bx;
-        INT32 Bmaxx = Bx;
-        BOOLEAN Bychange = FALSE;
-        BOOLEAN Bxchange = FALSE;
-        while (!Bychange) {
-            if (Bxchange) {		// if x-ord change then update x-ord min/max
-                if (Bx > Bmaxx) {
-                    Bmaxx = Bx;
-                }
-                else {
-                    Bminx = Bx;
-                }
-            }
-            // [x,y] point on B line
-            if (Bx == Btargetx && By == Btargety) {	// check if reached end
-                Bcomplete = TRUE;
-                break;
-            }
-            INT32 Be2 = 2 * Berror;
-            if (Be2 >= Bdy) {
-                // update x-ord
-                if (Bx == Btargetx) {	// check if reached end
-                    Bcomplete = TRUE;
-                    break;
-                }
-                Berror += Bdy;
-                Bx += Bsx;
-                Bxchange = TRUE;
-            }
-            if (Be2 <= Bdx) {
-                // update y-ord				
-                if (By == Btargety) {	// check if reached end
-                    Bcomplete = TRUE;
-                    break;
-                }
-                Berror += Bdx;
-                By += Bsy;
-                if (By == Ay) {			// matched y-ord on A line
-                    Bychange = TRUE;
-                } else {
-                    // B y-ord changed but not matching A y-ord so reset x-ord min/mix and go round again
-                    Bminx = Bx;
-                    Bmaxx = Bx;
-                }
-            }
-        }
-        // draw horizontial line A to B
-        {
-            INT32 xl = (Aminx < Bminx) ? Aminx : Bminx;
-            INT32 xr = (Amaxx > Bmaxx) ? Amaxx : Bmaxx;
-            INT32 y = currentY;
-            if (y < gCurrRenBuf->ClipY0 || y > gCurrRenBuf->ClipY1 || xr < gCurrRenBuf->ClipX0 || xl > gCurrRenBuf->ClipX1) {
-                goto skip;  // off screen
-            }
-            if (xl < gCurrRenBuf->ClipX0) {
-                xl = gCurrRenBuf->ClipX0;
-            }
-            if (xr > gCurrRenBuf->ClipX1) {
-                xr = gCurrRenBuf->ClipX1;
-            }
-            INT32 width = xr - xl + 1;
-            // draw line
-            UINT32 *ptr = gCurrRenBuf->PixelData + xl + (y * gCurrRenBuf->PixPerScnLn);
-            SetMem32(ptr, width * sizeof(UINT32), colour);
-            skip:;  // ";" as complier requires a statement after label!
-        }
-        if (!Acomplete && Bcomplete && Bx == x1 && By == y1) {	// switch to next B segment
-            // B [x1,y1] -> [x2,y2]
-            Bx = x1;
-            By = y1;
-            Btargetx = x2;
-            Btargety = y2;
-            Bdx = ABS(Btargetx - Bx);
-            Bsx = Bx < Btargetx ? 1 : -1;
-            Bdy = -ABS(Btargety - By);
-            Bsy = By < Btargety ? 1 : -1;
-            Berror = Bdx + Bdy;
-            Bcomplete = FALSE;
+            SetMem32(ptr + xl, (xr - xl + 1) * sizeof(UINT32), colour);
         }
+        ptr += Ctx->RenBuf->PixPerScnLn;
     }
     EDK2SIM_GFX_END;
 }
 
-VOID DrawRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour)
+VOID DrawMeshTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 colour)
 {
-    DbgPrint(DL_INFO, "%a(x0=%d, y0=%d, x1=%d, y1=%d, colour=0x%08X)\n", __func__, x0, y0, x1, y1, colour);
+    DbgPrint(DL_INFO, "%a(x0=%d, y0=%d, x1=%d, y1=%d, x2=%d, y2=%d colour=0x%08X)\n", __func__, x0, y0, x1, y1, x2, y2, colour);
 
     if (!Initialised) {
         DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => 0\n", __func__);
         return;
     }
-    // determine top-left and bottom-right
-    INT32 xl, xr, yt, yb;
-    if (x0 < x1) {
-        xl = x0;
-        xr = x1;
-    } else {
-        xl = x1;
-        xr = x0;
-    }
-    if (y0 < y1) {
-        yt = y0;
-        yb = y1;
-    } else {
-        yt = y1;
-        yb = y0;
-    }
-    // clip rectamgle
-    if (yb < gCurrRenBuf->ClipY0 || yt > gCurrRenBuf->ClipY1 || xr < gCurrRenBuf->ClipX0 || xl > gCurrRenBuf->ClipX1) {
+    draw_mesh_triangle(&gCurrCtx, x0, y0, x1, y1, x2, y2, colour);
+}
+
+VOID CtxDrawMeshTriangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, x2=%d, y2=%d colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, x2, y2, colour);
+
+    if (!check_context(Ctx)) {
         return;
     }
-    INT32 width = xr - xl + 1;
-    INT32 height = yb - yt + 1;
-    BOOLEAN left=TRUE, right=TRUE, top=TRUE, bottom=TRUE;
-    if (xl < gCurrRenBuf->ClipX0) {
-        left = FALSE;
-        xl = gCurrRenBuf->ClipX0;
-        width = (xr - gCurrRenBuf->ClipX0 + 1);
-    }
-    if (xr > gCurrRenBuf->ClipX1) {
-        right = FALSE;
-        width -= (xr - gCurrRenBuf->ClipX1);
-    }
-    if (yt < gCurrRenBuf->ClipY0) {
-        top = FALSE;
-        yt = gCurrRenBuf->ClipY0;
-        height = (yb - gCurrRenBuf->ClipY0 + 1);
-    }
-    if (yb > gCurrRenBuf->ClipY1) {
-        bottom = FALSE;
-        height -= (yb - gCurrRenBuf->ClipY1);
+    draw_mesh_triangle(Ctx, x0, y0, x1, y1, x2, y2, colour);
+}
+
+/*
+ * fill_span() - RASTER_SPAN that fills span with colour pointed to by Data
+ */
+STATIC VOID fill_span(GFX_CONTEXT *Ctx, CONST RASTER_TRI *Tri, INT32 y, INT32 xl, INT32 xr, VOID *Data)
+{
+    (VOID)Tri;  // flat colour, no edge interpolation
+    UINT32 *ptr = Ctx->RenBuf->PixelData + xl + (y * Ctx->RenBuf->PixPerScnLn);
+    SetMem32(ptr, (xr - xl + 1) * sizeof(UINT32), *(UINT32 *)Data);
+}
+
+STATIC VOID draw_mesh_triangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, x2=%d, y2=%d colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, x2, y2, colour);
+
+    // vertices are at pixel centres
+    RASTER_TRI Tri;
+    if (!raster_setup(Ctx, &Tri,
+                      PIXEL_TO_SUBPIXEL(x0), PIXEL_TO_SUBPIXEL(y0),
+                      PIXEL_TO_SUBPIXEL(x1), PIXEL_TO_SUBPIXEL(y1),
+                      PIXEL_TO_SUBPIXEL(x2), PIXEL_TO_SUBPIXEL(y2))) {
+        return;
     }
-    // draw rectangle
     EDK2SIM_GFX_BEGIN;
-    UINT32 *ptr = gCurrRenBuf->PixelData + xl + (yt * gCurrRenBuf->PixPerScnLn);
-    // top line
-    if (top) {
-        SetMem32(ptr, width * sizeof(UINT32), colour);
-        ptr += (width - 1);
-    } else {
-        ptr += (width - 1);
+    raster_triangle(Ctx, &Tri, fill_span, &colour);
+    EDK2SIM_GFX_END;
+}
+
+/*
+ * raster_edge() - set up edge function for edge [xa,ya] -> [xb,yb]
+ *
+ * E(p) = (b - a) x (p - a) is positive inside a triangle wound with positive
+ * area. Pixel centres exactly on an edge belong to it only if it is a top or
+ * left edge, folded in as a bias so coverage is simply E >= 0.
+ */
+STATIC VOID raster_edge(RASTER_EDGE *Edge, INT64 xa, INT64 ya, INT64 xb, INT64 yb)
+{
+    INT64 dx = xb - xa;
+    INT64 dy = yb - ya;
+    BOOLEAN TopLeft = (dy < 0 || (dy == 0 && dx > 0));
+
+    Edge->StepX = -dy * SUBPIXEL_ONE;
+    Edge->StepY = dx * SUBPIXEL_ONE;
+    Edge->E0 = dx * (SUBPIXEL_HALF - ya) - dy * (SUBPIXEL_HALF - xa) - (TopLeft ? 0 : 1);
+}
+
+/*
+ * raster_setup() - set up edges and clipped pixel bounds, FALSE if nothing to draw
+ *
+ * Vertices are in subpixel units, as are the edge function values (squared).
+ */
+STATIC BOOLEAN raster_setup(GFX_CONTEXT *Ctx, RASTER_TRI *Tri, INT64 x0, INT64 y0, INT64 x1, INT64 y1, INT64 x2, INT64 y2)
+{
+    if (ABS(x0) > RASTER_GUARD_BAND || ABS(y0) > RASTER_GUARD_BAND ||
+        ABS(x1) > RASTER_GUARD_BAND || ABS(y1) > RASTER_GUARD_BAND ||
+        ABS(x2) > RASTER_GUARD_BAND || ABS(y2) > RASTER_GUARD_BAND) {
+        DbgPrint(DL_WARN, "%a(), vertex outside guard band\n", __func__);
+        return FALSE;
     }
-    // right line
-    if (right) {
-        INT32 h = height;
-        while (TRUE) {
-            *ptr = colour;
-            h--;
-            if (!h) break;
-            ptr += gCurrRenBuf->PixPerScnLn;
-        }
-    } else {
-        ptr += (gCurrRenBuf->PixPerScnLn * (height - 1));
+    Tri->Area = (x1 - x0) * (y2 - y0) - (y1 - y0) * (x2 - x0);
+    if (Tri->Area == 0) {
+        return FALSE;
     }
-    // bottom line 
-    if (bottom) {
-        ptr -= (width - 1);
-        SetMem32(ptr, width * sizeof(UINT32), colour);
+    if (Tri->Area < 0) {
+        // make winding consistent
+        SWAP(INT64, x1, x2);
+        SWAP(INT64, y1, y2);
+        Tri->Area = -Tri->Area;
+        Tri->Swapped = TRUE;
     } else {
-        ptr -= (width - 1);
+        Tri->Swapped = FALSE;
+    }
+    // pixel bounds, pixel x is covered only if its centre x*ONE+HALF is inside
+    INT64 MinX = MIN(MIN(x0, x1), x2);
+    INT64 MaxX = MAX(MAX(x0, x1), x2);
+    INT64 MinY = MIN(MIN(y0, y1), y2);
+    INT64 MaxY = MAX(MAX(y0, y1), y2);
+    INT64 Lo = ARShiftU64(MinX - SUBPIXEL_HALF + SUBPIXEL_ONE - 1, SUBPIXEL_BITS);
+    INT64 Hi = ARShiftU64(MaxX - SUBPIXEL_HALF, SUBPIXEL_BITS);
+    Tri->MinX = (INT32)((Lo < Ctx->ClipX0) ? Ctx->ClipX0 : Lo);
+    Tri->MaxX = (INT32)((Hi > Ctx->ClipX1) ? Ctx->ClipX1 : Hi);
+    Lo = ARShiftU64(MinY - SUBPIXEL_HALF + SUBPIXEL_ONE - 1, SUBPIXEL_BITS);
+    Hi = ARShiftU64(MaxY - SUBPIXEL_HALF, SUBPIXEL_BITS);
+    Tri->MinY = (INT32)((Lo < Ctx->ClipY0) ? Ctx->ClipY0 : Lo);
+    Tri->MaxY = (INT32)((Hi > Ctx->ClipY1) ? Ctx->ClipY1 : Hi);
+    if (Tri->MinX > Tri->MaxX || Tri->MinY > Tri->MaxY) {
+        return FALSE;
     }
-    // left line
-    if (left) {
-        INT32 h = height;
-        while (TRUE) {
-            *ptr = colour;
-            h--;
-            if (!h) break;
-            ptr -= gCurrRenBuf->PixPerScnLn;
+    // edge i is opposite vertex i
+    raster_edge(&Tri->Edge[0], x1, y1, x2, y2);
+    raster_edge(&Tri->Edge[1], x2, y2, x0, y0);
+    raster_edge(&Tri->Edge[2], x0, y0, x1, y1);
+    return TRUE;
+}
+
+/*
+ * floor_div() - floor(n / d) for d > 0, remainder in [0,d)
+ */
+STATIC INT64 floor_div(INT64 n, INT64 d, INT64 *r)
+{
+    INT64 rem;
+    INT64 q = DivS64x64Remainder(n, d, &rem);
+    if (rem < 0) {
+        q--;
+        rem += d;
+    }
+    *r = rem;
+    return q;
+}
+
+/*
+ * raster_triangle() - call Span for each row of covered pixels
+ *
+ * Along a row an edge function only changes sign once, so each edge bounds the
+ * span on one side: at x >= ceil(-E/StepX) if StepX > 0, x <= floor(E/-StepX)
+ * if StepX < 0. That bound is floor(E/|StepX|) stepped per row as a quotient
+ * and remainder, giving exactly the pixels E >= 0 selects with no per pixel
+ * tests and no divisions after setup.
+ */
+STATIC VOID raster_triangle(GFX_CONTEXT *Ctx, CONST RASTER_TRI *Tri, RASTER_SPAN Span, VOID *Data)
+{
+    RASTER_BOUND Left[2];
+    RASTER_BOUND Right[2];
+    UINTN NumLeft = 0;
+    UINTN NumRight = 0;
+    INT32 yt = Tri->MinY;
+    INT32 yb = Tri->MaxY;
+
+    for (UINTN i = 0; i < 3; i++) {
+        CONST RASTER_EDGE *Edge = &Tri->Edge[i];
+        INT64 E = Edge->E0 + Edge->StepY * yt;
+        if (Edge->StepX == 0) {
+            // horizontal, only limits rows (E >= 0 below a top edge, above a bottom edge)
+            INT64 Rem;
+            if (Edge->StepY > 0) {
+                // first row ceil(-E/StepY) = -floor(E/StepY)
+                INT64 j = -floor_div(E, Edge->StepY, &Rem);
+                if (j > 0) yt += (INT32)j;
+            } else {
+                INT64 j = floor_div(E, -Edge->StepY, &Rem);
+                if (yt + j < yb) yb = (INT32)(yt + j);
+            }
+            continue;
+        }
+        RASTER_BOUND *Bound = (Edge->StepX > 0) ? &Left[NumLeft++] : &Right[NumRight++];
+        Bound->S = ABS(Edge->StepX);
+        Bound->Q = floor_div(E, Bound->S, &Bound->R);
+        Bound->Dq = floor_div(Edge->StepY, Bound->S, &Bound->Dr);
+    }
+    for (INT32 y = Tri->MinY; y <= yb; y++) {
+        INT64 xl = Tri->MinX;
+        INT64 xr = Tri->MaxX;
+        for (UINTN i = 0; i < NumLeft; i++) {
+            // ceil(-E/s) = -floor(E/s)
+            RASTER_BOUND *Bound = &Left[i];
+            if (-Bound->Q > xl) xl = -Bound->Q;
+            Bound->Q += Bound->Dq;
+            Bound->R += Bound->Dr;
+            if (Bound->R >= Bound->S) {
+                Bound->R -= Bound->S;
+                Bound->Q++;
+            }
+        }
+        for (UINTN i = 0; i < NumRight; i++) {
+            RASTER_BOUND *Bound = &Right[i];
+            if (Bound->Q < xr) xr = Bound->Q;
+            Bound->Q += Bound->Dq;
+            Bound->R += Bound->Dr;
+            if (Bound->R >= Bound->S) {
+                Bound->R -= Bound->S;
+                Bound->Q++;
+            }
+        }
+        if (xl <= xr && y >= yt) {
+            Span(Ctx, Tri, y, (INT32)xl, (INT32)xr, Data);
         }
     }
-    EDK2SIM_GFX_END;
 }
 
-VOID DrawFillRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour)
+VOID DrawShadedTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 c0, UINT32 c1, UINT32 c2)
 {
-    DbgPrint(DL_INFO, "%a(x0=%d, y0=%d, x1=%d, y1=%d, colour=0x%08X)\n", __func__, x0, y0, x1, y1, colour);
+    DbgPrint(DL_INFO, "%a(x0=%d, y0=%d, x1=%d, y1=%d, x2=%d, y2=%d, c0=0x%08X, c1=0x%08X, c2=0x%08X)\n", __func__, x0, y0, x1, y1, x2, y2, c0, c1, c2);
 
     if (!Initialised) {
         DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => 0\n", __func__);
         return;
     }
-    // determine top-left and bottom-right
-    INT32 xl, xr, yt, yb;
-    if (x0 < x1) {
-        xl = x0;
-        xr = x1;
-    } else {
-        xl = x1;
-        xr = x0;
-    }
-    if (y0 < y1) {
-        yt = y0;
-        yb = y1;
-    } else {
-        yt = y1;
-        yb = y0;
-    }
-    // clip rectamgle
-    if (yb < gCurrRenBuf->ClipY0 || yt > gCurrRenBuf->ClipY1 || xr < gCurrRenBuf->ClipX0 || xl > gCurrRenBuf->ClipX1) {
+    draw_shaded_triangle(&gCurrCtx, x0, y0, x1, y1, x2, y2, c0, c1, c2);
+}
+
+VOID CtxDrawShadedTriangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 c0, UINT32 c1, UINT32 c2)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, x2=%d, y2=%d, c0=0x%08X, c1=0x%08X, c2=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, x2, y2, c0, c1, c2);
+
+    if (!check_context(Ctx)) {
         return;
     }
-    UINT32 width = xr - xl + 1;
-    UINT32 height = yb - yt + 1;
-    if (xl < gCurrRenBuf->ClipX0) {
-        xl = gCurrRenBuf->ClipX0;
-        width = (xr - gCurrRenBuf->ClipX0 + 1);
-    }
-    if (xr > gCurrRenBuf->ClipX1) {
-        width -= (xr - gCurrRenBuf->ClipX1);
+    draw_shaded_triangle(Ctx, x0, y0, x1, y1, x2, y2, c0, c1, c2);
+}
+
+/*
+ * shade_span() - RASTER_SPAN that fills span with colours interpolated from SHADE_INFO
+ */
+STATIC VOID shade_span(GFX_CONTEXT *Ctx, CONST RASTER_TRI *Tri, INT32 y, INT32 xl, INT32 xr, VOID *Data)
+{
+    CONST SHADE_INFO *Shade = Data;
+    INT64 W1 = plane_weight(&Tri->Edge[1], xl, y, Tri->Area);
+    INT64 W2 = plane_weight(&Tri->Edge[2], xl, y, Tri->Area);
+    INT64 Len = xr - xl;
+    INT32 C[3];
+    INT32 Step[3];
+    BOOLEAN InRange = TRUE;
+
+    // channel values at each end of span (16.16), the start from its barycentric
+    // weights so it is exact even where a sliver's gradients were clamped
+    for (UINTN k = 0; k < 3; k++) {
+        INT64 Start = Shade->Base[k] + ARShiftU64((W1 * Shade->D1[k]) + (W2 * Shade->D2[k]) + ((INT64)1 << (PLANE_WEIGHT_BITS - 1)), PLANE_WEIGHT_BITS);
+        INT64 End = Start + Shade->Gx[k] * Len;
+        if (Start < 0 || Start > SHADE_MAX || End < 0 || End > SHADE_MAX) {
+            InRange = FALSE;
+            Start = (Start < 0) ? 0 : (Start > SHADE_MAX) ? SHADE_MAX : Start;
+        }
+        C[k] = (INT32)Start;
+        Step[k] = (INT32)Shade->Gx[k];
+    }
+    UINT32 *ptr = Ctx->RenBuf->PixelData + xl + (y * Ctx->RenBuf->PixPerScnLn);
+    UINT32 *end = ptr + Len;
+    if (InRange) {
+        while (ptr <= end) {
+            *ptr++ = ((UINT32)(C[0] >> 16) << 16) | ((UINT32)(C[1] >> 16) << 8) | (UINT32)(C[2] >> 16);
+            C[0] += Step[0];
+            C[1] += Step[1];
+            C[2] += Step[2];
+        }
+        return;
     }
-    if (yt < gCurrRenBuf->ClipY0) {
-        yt = gCurrRenBuf->ClipY0;
-        height = (yb - gCurrRenBuf->ClipY0 + 1);
+    // rounding takes span just past a vertex colour, clamp every pixel
+    INT64 V[3] = { C[0], C[1], C[2] };
+    while (ptr <= end) {
+        UINT32 colour = 0;
+        for (UINTN k = 0; k < 3; k++) {
+            INT64 c = (V[k] < 0) ? 0 : (V[k] > SHADE_MAX) ? SHADE_MAX : V[k];
+            colour = (colour << 8) | (UINT32)(c >> 16);
+            V[k] += Step[k];
+        }
+        *ptr++ = colour;
     }
-    if (yb > gCurrRenBuf->ClipY1) {
-        height -= (yb - gCurrRenBuf->ClipY1);
+}
+
+/*
+ * draw_shaded_triangle() - Gouraud shaded triangle, same coverage as draw_mesh_triangle()
+ */
+STATIC VOID draw_shaded_triangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 c0, UINT32 c1, UINT32 c2)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, x2=%d, y2=%d, c0=0x%08X, c1=0x%08X, c2=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, x2, y2, c0, c1, c2);
+
+    RASTER_TRI Tri;
+    if (!raster_setup(Ctx, &Tri,
+                      PIXEL_TO_SUBPIXEL(x0), PIXEL_TO_SUBPIXEL(y0),
+                      PIXEL_TO_SUBPIXEL(x1), PIXEL_TO_SUBPIXEL(y1),
+                      PIXEL_TO_SUBPIXEL(x2), PIXEL_TO_SUBPIXEL(y2))) {
+        return;
     }
-    // draw rectangle    
-    if (gRenderToScreen) {
-        gGop->Blt(gGop, (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)&colour, EfiBltVideoFill, 0, 0, xl, yt, width, height, 0);
-    } else {        
-        UINT32 *ptr = gCurrRenBuf->PixelData + xl + (yt * gCurrRenBuf->PixPerScnLn);
-        while (height--) {
-            SetMem32(ptr, width * sizeof(UINT32), colour);
-            ptr += gCurrRenBuf->PixPerScnLn;
+    // each channel is a plane over the triangle
+    SHADE_INFO Shade;
+    UINT32 Colour[3] = { c0, c1, c2 };
+    INT64 Gy;
+    for (UINTN k = 0; k < 3; k++) {
+        UINTN Shift = 16 - (k * 8);     // red, green, blue
+        INT64 P[3];
+        for (UINTN i = 0; i < 3; i++) {
+            P[i] = (INT64)((Colour[i] >> Shift) & 0xFF) << 16;
         }
+        Shade.Base[k] = P[0];
+        Shade.D1[k] = (Tri.Swapped ? P[2] : P[1]) - P[0];
+        Shade.D2[k] = (Tri.Swapped ? P[1] : P[2]) - P[0];
+        plane_setup(&Tri, P, &Shade.Gx[k], &Gy);
     }
+    EDK2SIM_GFX_BEGIN;
+    raster_triangle(Ctx, &Tri, shade_span, &Shade);
+    EDK2SIM_GFX_END;
 }
 
 /*
- * DrawCircle()
+ * plane_setup() - x/y gradients of values P (in caller's vertex order) over triangle
+ *
+ * Edge i weights vertex i so dP/dx = sum(StepX[i] * P[i]) / Area, taken relative
+ * to vertex 0 (the edge steps sum to zero) to keep within 64 bits. Differences
+ * between vertex values must be within PLANE_MAX_DELTA.
  */
+STATIC VOID plane_setup(CONST RASTER_TRI *Tri, CONST INT64 *P, INT64 *Gx, INT64 *Gy)
+{
+    INT64 D1 = (Tri->Swapped ? P[2] : P[1]) - P[0];
+    INT64 D2 = (Tri->Swapped ? P[1] : P[2]) - P[0];
+    *Gx = plane_gradient(Tri->Edge[1].StepX * D1 + Tri->Edge[2].StepX * D2, Tri->Area);
+    *Gy = plane_gradient(Tri->Edge[1].StepY * D1 + Tri->Edge[2].StepY * D2, Tri->Area);
+}
 
-VOID DrawCircle(INT32 xc, INT32 yc, INT32 r, UINT32 colour)
+/*
+ * plane_gradient() - S/Area, clamped so slivers can't overflow span set up
+ */
+STATIC INT64 plane_gradient(INT64 S, INT64 Area)
 {
-    DbgPrint(DL_INFO, "%a(xc=%d, yc=%d, r=%d, colour=0x%08X)\n", __func__, xc, yc, r, colour);
+    INT64 g = DivS64x64Remainder(S, Area, NULL);
+    if (g > PLANE_MAX_GRADIENT) {
+        g = PLANE_MAX_GRADIENT;
+    } else if (g < -PLANE_MAX_GRADIENT) {
+        g = -PLANE_MAX_GRADIENT;
+    }
+    return g;
+}
+
+/*
+ * plane_weight() - E/Area for an edge at pixel [x,y] inside the triangle, the weight of
+ * the opposite vertex with PLANE_WEIGHT_BITS fraction bits
+ *
+ * Large areas are scaled down so E fits in 33 bits before the shift, leaving the weight
+ * within 2^-30 of exact.
+ */
+STATIC INT64 plane_weight(CONST RASTER_EDGE *Edge, INT32 x, INT32 y, INT64 Area)
+{
+    INT64 E = Edge->E0 + (Edge->StepX * x) + (Edge->StepY * y);
+    if (!(Edge->StepX > 0 || (Edge->StepX == 0 && Edge->StepY > 0))) {
+        E++;    // undo raster_edge()'s fill rule bias so the weights sum to one
+    }
+    E = (E < 0) ? 0 : (E > Area) ? Area : E;
+    UINTN Shift = (Area >> 32) ? (UINTN)HighBitSet64((UINT64)Area) - 32 : 0;
+    return (INT64)DivU64x64Remainder(LShiftU64(RShiftU64((UINT64)E, Shift), PLANE_WEIGHT_BITS), RShiftU64((UINT64)Area, Shift), NULL);
+}
+
+EFI_STATUS DrawTexturedTriangle(RENDER_BUFFER *Texture, CONST TEX_VERTEX *v0, CONST TEX_VERTEX *v1, CONST TEX_VERTEX *v2, UINT32 Flags, UINT32 ColourKey)
+{
+    DbgPrint(DL_INFO, "%a(Texture=0x%p, v0=0x%p, v1=0x%p, v2=0x%p, Flags=0x%X, ColourKey=0x%08X)\n", __func__, Texture, v0, v1, v2, Flags, ColourKey);
 
     if (!Initialised) {
-        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => 0\n", __func__);
-        return;
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
     }
-#if CIRCLE_OPTIMISATION
-    if (draw_full_circle(xc, yc, r, colour)) {
-        // full circle was drawn
-        return;
+    return draw_textured_triangle(&gCurrCtx, Texture, v0, v1, v2, Flags, ColourKey);
+}
+
+EFI_STATUS CtxDrawTexturedTriangle(GFX_CONTEXT *Ctx, RENDER_BUFFER *Texture, CONST TEX_VERTEX *v0, CONST TEX_VERTEX *v1, CONST TEX_VERTEX *v2, UINT32 Flags, UINT32 ColourKey)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Texture=0x%p, v0=0x%p, v1=0x%p, v2=0x%p, Flags=0x%X, ColourKey=0x%08X)\n", __func__, Ctx, Texture, v0, v1, v2, Flags, ColourKey);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
     }
-#endif
-    // draw_full_circle() returned FALSE!
-    draw_part_circle(xc, yc, r, colour);
+    return draw_textured_triangle(Ctx, Texture, v0, v1, v2, Flags, ColourKey);
 }
 
-STATIC VOID draw_part_circle(INT32 xc, INT32 yc, INT32 r, UINT32 colour)
+EFI_STATUS DrawTexturedQuad(RENDER_BUFFER *Texture, CONST TEX_VERTEX *Vertex, UINT32 Flags, UINT32 ColourKey)
 {
-    DbgPrint(DL_INFO, "%a(xc=%d, yc=%d, r=%d, colour=0x%08X)\n", __func__, xc, yc, r, colour);
+    DbgPrint(DL_INFO, "%a(Texture=0x%p, Vertex=0x%p, Flags=0x%X, ColourKey=0x%08X)\n", __func__, Texture, Vertex, Flags, ColourKey);
 
-    INT32 x = 0;
-    INT32 y = r;
-    INT32 d = 3 - 2 * r;
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_textured_quad(&gCurrCtx, Texture, Vertex, Flags, ColourKey);
+}
 
-    PutPixel(xc + x, yc + y, colour);
-    PutPixel(xc - x, yc + y, colour);
-    PutPixel(xc + x, yc - y, colour);
-    PutPixel(xc - x, yc - y, colour);
-    PutPixel(xc + y, yc + x, colour);
-    PutPixel(xc - y, yc + x, colour);
-    PutPixel(xc + y, yc - x, colour);
-    PutPixel(xc - y, yc - x, colour);
+EFI_STATUS CtxDrawTexturedQuad(GFX_CONTEXT *Ctx, RENDER_BUFFER *Texture, CONST TEX_VERTEX *Vertex, UINT32 Flags, UINT32 ColourKey)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Texture=0x%p, Vertex=0x%p, Flags=0x%X, ColourKey=0x%08X)\n", __func__, Ctx, Texture, Vertex, Flags, ColourKey);
 
-    while (y >= x) {
-        x++;
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_textured_quad(Ctx, Texture, Vertex, Flags, ColourKey);
+}
 
-        if (d > 0) {
-            y--;
-            d = d + 4 * (x - y) + 10;
-        } else {
-            d = d + 4 * x + 6;
-        }
+EFI_STATUS DrawSpriteAffine(RENDER_BUFFER *Sprite, INT32 px, INT32 py, INT32 x, INT32 y, CONST INT32 *Matrix, UINT32 Flags, UINT32 ColourKey)
+{
+    DbgPrint(DL_INFO, "%a(Sprite=0x%p, px=%d, py=%d, x=%d, y=%d, Matrix=0x%p, Flags=0x%X, ColourKey=0x%08X)\n", __func__, Sprite, px, py, x, y, Matrix, Flags, ColourKey);
 
-        PutPixel(xc + x, yc + y, colour);
-        PutPixel(xc - x, yc + y, colour);
-        PutPixel(xc + x, yc - y, colour);
-        PutPixel(xc - x, yc - y, colour);
-        PutPixel(xc + y, yc + x, colour);
-        PutPixel(xc - y, yc + x, colour);
-        PutPixel(xc + y, yc - x, colour);
-        PutPixel(xc - y, yc - x, colour);
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
     }
+    return draw_sprite_affine(&gCurrCtx, Sprite, px, py, x, y, Matrix, Flags, ColourKey);
 }
 
-#if CIRCLE_OPTIMISATION
-/*
- * draw_full_circle() - return TRUE if circle drawn
- */
-STATIC BOOLEAN draw_full_circle(INT32 xc, INT32 yc, INT32 r, UINT32 colour)
+EFI_STATUS CtxDrawSpriteAffine(GFX_CONTEXT *Ctx, RENDER_BUFFER *Sprite, INT32 px, INT32 py, INT32 x, INT32 y, CONST INT32 *Matrix, UINT32 Flags, UINT32 ColourKey)
 {
-    INT32 x = 0;
-    INT32 y = r;
-    INT32 d = 3 - 2 * r;
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Sprite=0x%p, px=%d, py=%d, x=%d, y=%d, Matrix=0x%p, Flags=0x%X, ColourKey=0x%08X)\n", __func__, Ctx, Sprite, px, py, x, y, Matrix, Flags, ColourKey);
 
-    DbgPrint(DL_INFO, "%a(xc=%d, yc=%d, r=%d, colour=0x%08X)\n", __func__, xc, yc, r, colour);
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_sprite_affine(Ctx, Sprite, px, py, x, y, Matrix, Flags, ColourKey);
+}
 
-    if (gCurrRenBuf->ClipX0 + r > xc || gCurrRenBuf->ClipX1 < xc + r || gCurrRenBuf->ClipY0 + r > yc || gCurrRenBuf->ClipY1 < yc + r) {
-        // circle is clipped so exit
-        return FALSE;
+EFI_STATUS DrawRotatedSprite(RENDER_BUFFER *Sprite, INT32 px, INT32 py, INT32 x, INT32 y, INT32 Angle, UINT32 Scale, UINT32 Flags, UINT32 ColourKey)
+{
+    DbgPrint(DL_INFO, "%a(Sprite=0x%p, px=%d, py=%d, x=%d, y=%d, Angle=%d, Scale=0x%X, Flags=0x%X, ColourKey=0x%08X)\n", __func__, Sprite, px, py, x, y, Angle, Scale, Flags, ColourKey);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
     }
+    INT32 Matrix[4];
+    rotation_matrix(Angle, Scale, Matrix);
+    return draw_sprite_affine(&gCurrCtx, Sprite, px, py, x, y, Matrix, Flags, ColourKey);
+}
 
-    // (xc + x, yc + y)
-    UINT32 *ptr_br = gCurrRenBuf->PixelData + xc + x + ((yc + y) * gCurrRenBuf->PixPerScnLn);
-    *ptr_br = colour;
-    // (xc - x, yc + y)
-    UINT32 *ptr_bl = ptr_br;
-    *ptr_br = colour;
-    // (xc + x, yc - y)
-    UINT32 *ptr_tr = gCurrRenBuf->PixelData + xc + x + ((yc - y) * gCurrRenBuf->PixPerScnLn);
-    *ptr_tr = colour;
+EFI_STATUS CtxDrawRotatedSprite(GFX_CONTEXT *Ctx, RENDER_BUFFER *Sprite, INT32 px, INT32 py, INT32 x, INT32 y, INT32 Angle, UINT32 Scale, UINT32 Flags, UINT32 ColourKey)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Sprite=0x%p, px=%d, py=%d, x=%d, y=%d, Angle=%d, Scale=0x%X, Flags=0x%X, ColourKey=0x%08X)\n", __func__, Ctx, Sprite, px, py, x, y, Angle, Scale, Flags, ColourKey);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    INT32 Matrix[4];
+    rotation_matrix(Angle, Scale, Matrix);
+    return draw_sprite_affine(Ctx, Sprite, px, py, x, y, Matrix, Flags, ColourKey);
+}
+
+/*
+ * lerp_colour() - blend colour a towards b by f/256, two channels per multiply
+ */
+STATIC UINT32 lerp_colour(UINT32 a, UINT32 b, UINT32 f)
+{
+    UINT32 rb = ((((a & 0xFF00FF) * (256 - f)) + ((b & 0xFF00FF) * f)) >> 8) & 0xFF00FF;
+    UINT32 ag = ((((a >> 8) & 0xFF00FF) * (256 - f)) + (((b >> 8) & 0xFF00FF) * f)) & 0xFF00FF00;
+    return rb | ag;
+}
+
+/*
+ * texture_span() - RASTER_SPAN that fills span with texels sampled via TEX_INFO
+ */
+STATIC VOID texture_span(GFX_CONTEXT *Ctx, CONST RASTER_TRI *Tri, INT32 y, INT32 xl, INT32 xr, VOID *Data)
+{
+    (VOID)Tri;  // u, v come from TEX_INFO's gradients
+    CONST TEX_INFO *Tex = Data;
+    CONST RENDER_BUFFER *Texture = Tex->Texture;
+    INT64 Dx = (INT64)xl * SUBPIXEL_ONE + SUBPIXEL_HALF - Tex->X0;
+    INT64 Dy = (INT64)y * SUBPIXEL_ONE + SUBPIXEL_HALF - Tex->Y0;
+    INT64 u = Tex->U0 + ARShiftU64(Tex->Gux * Dx + Tex->Guy * Dy, SUBPIXEL_BITS);
+    INT64 v = Tex->V0 + ARShiftU64(Tex->Gvx * Dx + Tex->Gvy * Dy, SUBPIXEL_BITS);
+    INT64 MaxU = ((INT64)Texture->HorRes << 16) - 1;
+    INT64 MaxV = ((INT64)Texture->VerRes << 16) - 1;
+    UINT32 *ptr = Ctx->RenBuf->PixelData + xl + (y * Ctx->RenBuf->PixPerScnLn);
+
+    // nearest texel with whole span inside texture needs no clamping
+    INT64 ue = u + Tex->Gux * (xr - xl);
+    INT64 ve = v + Tex->Gvx * (xr - xl);
+    if (Tex->Flags == TEX_NEAREST && u >= 0 && u <= MaxU && ue >= 0 && ue <= MaxU && v >= 0 && v <= MaxV && ve >= 0 && ve <= MaxV) {
+        INT32 Pitch = Texture->PixPerScnLn;
+        for (INT32 x = xl; x <= xr; x++, u += Tex->Gux, v += Tex->Gvx) {
+            *ptr++ = Texture->PixelData[(INT32)(u >> 16) + ((INT32)(v >> 16) * Pitch)];
+        }
+        return;
+    }
+    for (INT32 x = xl; x <= xr; x++, ptr++, u += Tex->Gux, v += Tex->Gvx) {
+        // clamp to texture edge
+        INT64 cu = (u < 0) ? 0 : (u > MaxU) ? MaxU : u;
+        INT64 cv = (v < 0) ? 0 : (v > MaxV) ? MaxV : v;
+        INT32 tx = (INT32)(cu >> 16);
+        INT32 ty = (INT32)(cv >> 16);
+        CONST UINT32 *row = Texture->PixelData + (ty * Texture->PixPerScnLn);
+        UINT32 texel = row[tx];
+        if ((Tex->Flags & TEX_COLOUR_KEY) && ((texel ^ Tex->ColourKey) & 0xFFFFFF) == 0) {
+            continue;
+        }
+        if (Tex->Flags & TEX_BILINEAR) {
+            // sample between the four texel centres around [u,v]
+            INT64 su = cu - 0x8000;
+            INT64 sv = cv - 0x8000;
+            su = (su < 0) ? 0 : (su > MaxU - 0xFFFF) ? MaxU - 0xFFFF : su;
+            sv = (sv < 0) ? 0 : (sv > MaxV - 0xFFFF) ? MaxV - 0xFFFF : sv;
+            INT32 x0 = (INT32)(su >> 16);
+            INT32 y0 = (INT32)(sv >> 16);
+            INT32 x1 = (x0 + 1 < Texture->HorRes) ? x0 + 1 : x0;
+            INT32 y1 = (y0 + 1 < Texture->VerRes) ? y0 + 1 : y0;
+            UINT32 fx = (UINT32)(su >> 8) & 0xFF;
+            UINT32 fy = (UINT32)(sv >> 8) & 0xFF;
+            CONST UINT32 *r0 = Texture->PixelData + (y0 * Texture->PixPerScnLn);
+            CONST UINT32 *r1 = Texture->PixelData + (y1 * Texture->PixPerScnLn);
+            texel = lerp_colour(lerp_colour(r0[x0], r0[x1], fx), lerp_colour(r1[x0], r1[x1], fx), fy);
+        }
+        if (Tex->Flags & TEX_ALPHA) {
+            UINT32 a = texel >> 24;
+            texel = lerp_colour(*ptr, texel, a + (a >> 7));
+        }
+        *ptr = texel;
+    }
+}
+
+/*
+ * draw_texture() - draw triangle (subpixel positions, 16.16 texel coords) mapping Texture
+ *
+ * Texture coords are planes over the triangle like the Gouraud channels, so
+ * each span starts with one 64 bit evaluation and then steps u/v per pixel.
+ */
+STATIC EFI_STATUS draw_texture(GFX_CONTEXT *Ctx, CONST RENDER_BUFFER *Texture, CONST INT64 *X, CONST INT64 *Y, CONST INT64 *U, CONST INT64 *V, UINT32 Flags, UINT32 ColourKey)
+{
+    RASTER_TRI Tri;
+    if (!raster_setup(Ctx, &Tri, X[0], Y[0], X[1], Y[1], X[2], Y[2])) {
+        return EFI_SUCCESS;
+    }
+    for (UINTN i = 1; i < 3; i++) {
+        if (ABS(U[i] - U[0]) > PLANE_MAX_DELTA || ABS(V[i] - V[0]) > PLANE_MAX_DELTA) {
+            DbgPrint(DL_ERROR, "%a(), texture coords too far apart => EFI_INVALID_PARAMETER\n", __func__);
+            return EFI_INVALID_PARAMETER;
+        }
+    }
+    TEX_INFO Tex;
+    Tex.Texture = Texture;
+    Tex.Flags = Flags;
+    Tex.ColourKey = ColourKey;
+    Tex.X0 = X[0];
+    Tex.Y0 = Y[0];
+    Tex.U0 = U[0];
+    Tex.V0 = V[0];
+    plane_setup(&Tri, U, &Tex.Gux, &Tex.Guy);
+    plane_setup(&Tri, V, &Tex.Gvx, &Tex.Gvy);
+
+    EDK2SIM_GFX_BEGIN;
+    raster_triangle(Ctx, &Tri, texture_span, &Tex);
+    EDK2SIM_GFX_END;
+
+    return EFI_SUCCESS;
+}
+
+/*
+ * check_texture() - TRUE if Texture is a usable render buffer
+ */
+STATIC BOOLEAN check_texture(CONST RENDER_BUFFER *Texture)
+{
+    if (!Texture || Texture->Sig != RENBUF_SIG || !Texture->PixelData || Texture->HorRes <= 0 || Texture->VerRes <= 0) {
+        DbgPrint(DL_ERROR, "%a(), invalid texture\n", __func__);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+STATIC EFI_STATUS draw_textured_triangle(GFX_CONTEXT *Ctx, CONST RENDER_BUFFER *Texture, CONST TEX_VERTEX *v0, CONST TEX_VERTEX *v1, CONST TEX_VERTEX *v2, UINT32 Flags, UINT32 ColourKey)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Texture=0x%p, v0=0x%p, v1=0x%p, v2=0x%p, Flags=0x%X, ColourKey=0x%08X)\n", __func__, Ctx, Texture, v0, v1, v2, Flags, ColourKey);
+
+    if (!check_texture(Texture) || !v0 || !v1 || !v2) {
+        return EFI_INVALID_PARAMETER;
+    }
+    // vertices are at pixel centres
+    INT64 X[3] = { PIXEL_TO_SUBPIXEL(v0->X), PIXEL_TO_SUBPIXEL(v1->X), PIXEL_TO_SUBPIXEL(v2->X) };
+    INT64 Y[3] = { PIXEL_TO_SUBPIXEL(v0->Y), PIXEL_TO_SUBPIXEL(v1->Y), PIXEL_TO_SUBPIXEL(v2->Y) };
+    INT64 U[3] = { v0->U, v1->U, v2->U };
+    INT64 V[3] = { v0->V, v1->V, v2->V };
+    return draw_texture(Ctx, Texture, X, Y, U, V, Flags, ColourKey);
+}
+
+STATIC EFI_STATUS draw_textured_quad(GFX_CONTEXT *Ctx, CONST RENDER_BUFFER *Texture, CONST TEX_VERTEX *Vertex, UINT32 Flags, UINT32 ColourKey)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Texture=0x%p, Vertex=0x%p, Flags=0x%X, ColourKey=0x%08X)\n", __func__, Ctx, Texture, Vertex, Flags, ColourKey);
+
+    if (!Vertex) {
+        DbgPrint(DL_ERROR, "%a(), Vertex=NULL => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    // split along 0-2, the fill rule stops the shared edge being drawn twice
+    EFI_STATUS Status = draw_textured_triangle(Ctx, Texture, &Vertex[0], &Vertex[1], &Vertex[2], Flags, ColourKey);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    return draw_textured_triangle(Ctx, Texture, &Vertex[0], &Vertex[2], &Vertex[3], Flags, ColourKey);
+}
+
+/*
+ * draw_sprite_affine() - draw Sprite transformed by 16.16 Matrix {a, b, c, d} about
+ *                        its point [px,py], which lands on the top-left of pixel [x,y]
+ *
+ * Sprite point [sx,sy] goes to [x + a(sx-px) + b(sy-py), y + c(sx-px) + d(sy-py)].
+ */
+STATIC EFI_STATUS draw_sprite_affine(GFX_CONTEXT *Ctx, CONST RENDER_BUFFER *Sprite, INT32 px, INT32 py, INT32 x, INT32 y, CONST INT32 *Matrix, UINT32 Flags, UINT32 ColourKey)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Sprite=0x%p, px=%d, py=%d, x=%d, y=%d, Matrix=0x%p, Flags=0x%X, ColourKey=0x%08X)\n", __func__, Ctx, Sprite, px, py, x, y, Matrix, Flags, ColourKey);
+
+    if (!check_texture(Sprite) || !Matrix) {
+        return EFI_INVALID_PARAMETER;
+    }
+    // corners of sprite
+    INT64 Cu[4] = { 0, Sprite->HorRes, Sprite->HorRes, 0 };
+    INT64 Cv[4] = { 0, 0, Sprite->VerRes, Sprite->VerRes };
+    INT64 X[4], Y[4], U[4], V[4];
+    for (UINTN i = 0; i < 4; i++) {
+        INT64 su = Cu[i] - px;
+        INT64 sv = Cv[i] - py;
+        // 16.16 => subpixel
+        X[i] = (INT64)x * SUBPIXEL_ONE + ARShiftU64(Matrix[0] * su + Matrix[1] * sv, 16 - SUBPIXEL_BITS);
+        Y[i] = (INT64)y * SUBPIXEL_ONE + ARShiftU64(Matrix[2] * su + Matrix[3] * sv, 16 - SUBPIXEL_BITS);
+        U[i] = LShiftU64(Cu[i], 16);
+        V[i] = LShiftU64(Cv[i], 16);
+    }
+    INT64 X2[3] = { X[0], X[2], X[3] };
+    INT64 Y2[3] = { Y[0], Y[2], Y[3] };
+    INT64 U2[3] = { U[0], U[2], U[3] };
+    INT64 V2[3] = { V[0], V[2], V[3] };
+    EFI_STATUS Status = draw_texture(Ctx, Sprite, X, Y, U, V, Flags, ColourKey);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    return draw_texture(Ctx, Sprite, X2, Y2, U2, V2, Flags, ColourKey);
+}
+
+// sin 0..90 degrees, 16.16
+STATIC CONST INT32 gSinTable[91] = {
+    0, 1144, 2287, 3430, 4572, 5712, 6850, 7987,
+    9121, 10252, 11380, 12505, 13626, 14742, 15855, 16962,
+    18064, 19161, 20252, 21336, 22415, 23486, 24550, 25607,
+    26656, 27697, 28729, 29753, 30767, 31772, 32768, 33754,
+    34729, 35693, 36647, 37590, 38521, 39441, 40348, 41243,
+    42126, 42995, 43852, 44695, 45525, 46341, 47143, 47930,
+    48703, 49461, 50203, 50931, 51643, 52339, 53020, 53684,
+    54332, 54963, 55578, 56175, 56756, 57319, 57865, 58393,
+    58903, 59396, 59870, 60326, 60764, 61183, 61584, 61966,
+    62328, 62672, 62997, 63303, 63589, 63856, 64104, 64332,
+    64540, 64729, 64898, 65048, 65177, 65287, 65376, 65446,
+    65496, 65526, 65536
+};
+
+/*
+ * fixed_sin() - sin of Angle (tenths of a degree) in 16.16
+ */
+STATIC INT32 fixed_sin(INT32 Angle)
+{
+    INT32 a = Angle % 3600;
+    if (a < 0) {
+        a += 3600;
+    }
+    INT32 Sign = 1;
+    if (a >= 1800) {
+        a -= 1800;
+        Sign = -1;
+    }
+    if (a > 900) {
+        a = 1800 - a;
+    }
+    // interpolate between whole degrees
+    INT32 d = a / 10;
+    INT32 f = a % 10;
+    INT32 s = gSinTable[d];
+    if (f) {
+        s += ((gSinTable[d + 1] - s) * f) / 10;
+    }
+    return Sign * s;
+}
+
+/*
+ * rotation_matrix() - 16.16 matrix rotating clockwise (on screen) by Angle tenths of a degree, then scaling
+ */
+STATIC VOID rotation_matrix(INT32 Angle, UINT32 Scale, INT32 *Matrix)
+{
+    INT64 s = ARShiftU64((INT64)fixed_sin(Angle) * Scale, 16);
+    INT64 c = ARShiftU64((INT64)fixed_sin(Angle + 900) * Scale, 16);
+    Matrix[0] = (INT32)c;
+    Matrix[1] = (INT32)-s;
+    Matrix[2] = (INT32)s;
+    Matrix[3] = (INT32)c;
+}
+
+VOID MatrixIdentity(MATRIX4 *M)
+{
+    DbgPrint(DL_INFO, "%a(M=0x%p)\n", __func__, M);
+
+    ZeroMem(M, sizeof(MATRIX4));
+    for (UINTN i = 0; i < 4; i++) {
+        M->M[i][i] = 0x10000;
+    }
+}
+
+/*
+ * MatrixMultiply() - Result = A * B (B is applied first), Result may be A or B
+ */
+VOID MatrixMultiply(MATRIX4 *Result, CONST MATRIX4 *A, CONST MATRIX4 *B)
+{
+    DbgPrint(DL_INFO, "%a(Result=0x%p, A=0x%p, B=0x%p)\n", __func__, Result, A, B);
+
+    MATRIX4 R;
+    for (UINTN i = 0; i < 4; i++) {
+        for (UINTN j = 0; j < 4; j++) {
+            INT64 Sum = 0;
+            for (UINTN k = 0; k < 4; k++) {
+                Sum += (INT64)A->M[i][k] * B->M[k][j];
+            }
+            R.M[i][j] = (INT32)ARShiftU64(Sum, 16);
+        }
+    }
+    CopyMem(Result, &R, sizeof(MATRIX4));
+}
+
+VOID MatrixTranslation(MATRIX4 *M, INT32 x, INT32 y, INT32 z)
+{
+    DbgPrint(DL_INFO, "%a(M=0x%p, x=%d, y=%d, z=%d)\n", __func__, M, x, y, z);
+
+    MatrixIdentity(M);
+    M->M[0][3] = x;
+    M->M[1][3] = y;
+    M->M[2][3] = z;
+}
+
+VOID MatrixScaling(MATRIX4 *M, INT32 x, INT32 y, INT32 z)
+{
+    DbgPrint(DL_INFO, "%a(M=0x%p, x=%d, y=%d, z=%d)\n", __func__, M, x, y, z);
+
+    MatrixIdentity(M);
+    M->M[0][0] = x;
+    M->M[1][1] = y;
+    M->M[2][2] = z;
+}
+
+/*
+ * MatrixRotationX() - rotate Y towards Z (anticlockwise looking down the axis)
+ */
+VOID MatrixRotationX(MATRIX4 *M, INT32 Angle)
+{
+    DbgPrint(DL_INFO, "%a(M=0x%p, Angle=%d)\n", __func__, M, Angle);
+
+    INT32 s = fixed_sin(Angle);
+    INT32 c = fixed_sin(Angle + 900);
+    MatrixIdentity(M);
+    M->M[1][1] = c;
+    M->M[1][2] = -s;
+    M->M[2][1] = s;
+    M->M[2][2] = c;
+}
+
+/*
+ * MatrixRotationY() - rotate Z towards X
+ */
+VOID MatrixRotationY(MATRIX4 *M, INT32 Angle)
+{
+    DbgPrint(DL_INFO, "%a(M=0x%p, Angle=%d)\n", __func__, M, Angle);
+
+    INT32 s = fixed_sin(Angle);
+    INT32 c = fixed_sin(Angle + 900);
+    MatrixIdentity(M);
+    M->M[0][0] = c;
+    M->M[0][2] = s;
+    M->M[2][0] = -s;
+    M->M[2][2] = c;
+}
+
+/*
+ * MatrixRotationZ() - rotate X towards Y
+ */
+VOID MatrixRotationZ(MATRIX4 *M, INT32 Angle)
+{
+    DbgPrint(DL_INFO, "%a(M=0x%p, Angle=%d)\n", __func__, M, Angle);
+
+    INT32 s = fixed_sin(Angle);
+    INT32 c = fixed_sin(Angle + 900);
+    MatrixIdentity(M);
+    M->M[0][0] = c;
+    M->M[0][1] = -s;
+    M->M[1][0] = s;
+    M->M[1][1] = c;
+}
+
+/*
+ * MatrixPerspective() - projection for a camera at the origin looking down -Z with Y up
+ *
+ * Fov is the vertical field of view, Aspect is width / height. Maps Near..Far
+ * to NDC depth -1..1 as OpenGL does.
+ */
+EFI_STATUS MatrixPerspective(MATRIX4 *M, INT32 Fov, INT32 Aspect, INT32 Near, INT32 Far)
+{
+    DbgPrint(DL_INFO, "%a(M=0x%p, Fov=%d, Aspect=%d, Near=%d, Far=%d)\n", __func__, M, Fov, Aspect, Near, Far);
+
+    if (Fov <= 0 || Fov >= 1800 || Aspect <= 0 || Near <= 0 || Far <= Near) {
+        DbgPrint(DL_ERROR, "%a(), invalid projection => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    // cot(Fov / 2)
+    INT64 f = DivS64x64Remainder(LShiftU64(fixed_sin(Fov / 2 + 900), 16), fixed_sin(Fov / 2), NULL);
+    ZeroMem(M, sizeof(MATRIX4));
+    M->M[0][0] = (INT32)DivS64x64Remainder(LShiftU64(f, 16), Aspect, NULL);
+    M->M[1][1] = (INT32)f;
+    M->M[2][2] = (INT32)DivS64x64Remainder(LShiftU64((INT64)Far + Near, 16), Near - Far, NULL);
+    M->M[2][3] = (INT32)DivS64x64Remainder(2 * (INT64)Far * Near, Near - Far, NULL);
+    M->M[3][2] = -0x10000;
+
+    return EFI_SUCCESS;
+}
+
+EFI_STATUS DrawMesh(CONST MATRIX4 *Transform, CONST VERTEX3 *Vertices, UINTN NumVertices, CONST UINT32 *Indices, UINTN NumTriangles, CONST UINT32 *Colours, UINT32 Flags)
+{
+    DbgPrint(DL_INFO, "%a(Transform=0x%p, Vertices=0x%p, NumVertices=%u, Indices=0x%p, NumTriangles=%u, Colours=0x%p, Flags=0x%X)\n", __func__, Transform, Vertices, NumVertices, Indices, NumTriangles, Colours, Flags);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_mesh(&gCurrCtx, Transform, Vertices, NumVertices, Indices, NumTriangles, Colours, Flags);
+}
+
+EFI_STATUS CtxDrawMesh(GFX_CONTEXT *Ctx, CONST MATRIX4 *Transform, CONST VERTEX3 *Vertices, UINTN NumVertices, CONST UINT32 *Indices, UINTN NumTriangles, CONST UINT32 *Colours, UINT32 Flags)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Transform=0x%p, Vertices=0x%p, NumVertices=%u, Indices=0x%p, NumTriangles=%u, Colours=0x%p, Flags=0x%X)\n", __func__, Ctx, Transform, Vertices, NumVertices, Indices, NumTriangles, Colours, Flags);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_mesh(Ctx, Transform, Vertices, NumVertices, Indices, NumTriangles, Colours, Flags);
+}
+
+/*
+ * draw_mesh() - transform vertices once, then clip, cull and fill each indexed triangle
+ */
+STATIC EFI_STATUS draw_mesh(GFX_CONTEXT *Ctx, CONST MATRIX4 *Transform, CONST VERTEX3 *Vertices, UINTN NumVertices, CONST UINT32 *Indices, UINTN NumTriangles, CONST UINT32 *Colours, UINT32 Flags)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Transform=0x%p, Vertices=0x%p, NumVertices=%u, Indices=0x%p, NumTriangles=%u, Colours=0x%p, Flags=0x%X)\n", __func__, Ctx, Transform, Vertices, NumVertices, Indices, NumTriangles, Colours, Flags);
+
+    if (!Transform || !Vertices || !Indices || !Colours) {
+        DbgPrint(DL_ERROR, "%a(), NULL parameter => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    if ((Flags & MESH_DEPTH_TEST) && !Ctx->RenBuf->DepthData) {
+        DbgPrint(DL_ERROR, "%a(), no depth buffer => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    if (NumTriangles > MAX_UINTN / 3 || NumVertices > MAX_UINTN / sizeof(CLIP_VERTEX)) {
+        DbgPrint(DL_ERROR, "%a(), NumTriangles=%u or NumVertices=%u too large => EFI_INVALID_PARAMETER\n", __func__, NumTriangles, NumVertices);
+        return EFI_INVALID_PARAMETER;
+    }
+    for (UINTN i = 0; i < NumTriangles * 3; i++) {
+        if (Indices[i] >= NumVertices) {
+            DbgPrint(DL_ERROR, "%a(), Indices[%u]=%u out of range => EFI_INVALID_PARAMETER\n", __func__, i, Indices[i]);
+            return EFI_INVALID_PARAMETER;
+        }
+    }
+    CLIP_VERTEX *Clip = AllocatePool(NumVertices * sizeof(CLIP_VERTEX));
+    if (Clip == NULL) {
+        DbgPrint(DL_ERROR, "%a(), memory allocation error => EFI_OUT_OF_RESOURCES\n", __func__);
+        return EFI_OUT_OF_RESOURCES;
+    }
+    // shared vertices are only transformed once
+    for (UINTN i = 0; i < NumVertices; i++) {
+        transform_vertex(Transform, &Vertices[i], &Clip[i]);
+    }
+
+    EDK2SIM_GFX_BEGIN;
+    for (UINTN t = 0; t < NumTriangles; t++) {
+        CLIP_VERTEX Poly[CLIP_MAX_VERTICES];
+        Poly[0] = Clip[Indices[t * 3]];
+        Poly[1] = Clip[Indices[t * 3 + 1]];
+        Poly[2] = Clip[Indices[t * 3 + 2]];
+        if (Poly[0].Outcode & Poly[1].Outcode & Poly[2].Outcode) {
+            // all outside one plane
+            continue;
+        }
+        UINTN Count = 3;
+        UINT32 Planes = Poly[0].Outcode | Poly[1].Outcode | Poly[2].Outcode;
+        if (Planes) {
+            Count = clip_polygon(Poly, Count, Planes);
+        }
+        draw_mesh_polygon(Ctx, Poly, Count, Colours[t], Flags);
+    }
+    EDK2SIM_GFX_END;
+
+    FreePool(Clip);
+
+    return EFI_SUCCESS;
+}
+
+/*
+ * transform_vertex() - vertex to clip space, scaled down (same point) to fit within CLIP_MAX_ORD
+ */
+STATIC VOID transform_vertex(CONST MATRIX4 *Transform, CONST VERTEX3 *Vertex, CLIP_VERTEX *Clip)
+{
+    INT64 C[4];
+    for (UINTN i = 0; i < 4; i++) {
+        C[i] = ARShiftU64((INT64)Transform->M[i][0] * Vertex->X + (INT64)Transform->M[i][1] * Vertex->Y + (INT64)Transform->M[i][2] * Vertex->Z, 16) + Transform->M[i][3];
+    }
+    INT64 Max = MAX(MAX(ABS(C[0]), ABS(C[1])), MAX(ABS(C[2]), ABS(C[3])));
+    UINTN Shift = 0;
+    while ((Max >> Shift) >= CLIP_MAX_ORD) {
+        Shift++;
+    }
+    Clip->X = ARShiftU64(C[0], Shift);
+    Clip->Y = ARShiftU64(C[1], Shift);
+    Clip->Z = ARShiftU64(C[2], Shift);
+    Clip->W = ARShiftU64(C[3], Shift);
+    Clip->Outcode = 0;
+    for (UINTN p = 0; p < CLIP_PLANES; p++) {
+        if (clip_distance(Clip, p) < 0) {
+            Clip->Outcode |= 1 << p;
+        }
+    }
+}
+
+/*
+ * clip_distance() - signed distance to clip plane, inside if >= 0
+ *
+ * Planes are near, far then x and y guard bands, so NDC x and y are not
+ * clipped to -1..1 (the rasteriser clips those exactly) but only kept within
+ * what raster_setup() accepts.
+ */
+STATIC INT64 clip_distance(CONST CLIP_VERTEX *Vertex, UINTN Plane)
+{
+    switch (Plane) {
+        case 0:  return Vertex->W + Vertex->Z;
+        case 1:  return Vertex->W - Vertex->Z;
+        case 2:  return CLIP_GUARD * Vertex->W + Vertex->X;
+        case 3:  return CLIP_GUARD * Vertex->W - Vertex->X;
+        case 4:  return CLIP_GUARD * Vertex->W + Vertex->Y;
+        default: return CLIP_GUARD * Vertex->W - Vertex->Y;
+    }
+}
+
+/*
+ * clip_polygon() - clip convex polygon against Planes in place (Sutherland-Hodgman), new vertex count
+ *
+ * Poly must have room for CLIP_MAX_VERTICES. Intersections are always found
+ * from the inside vertex so triangles sharing an edge get the same new vertex.
+ */
+STATIC UINTN clip_polygon(CLIP_VERTEX *Poly, UINTN Count, UINT32 Planes)
+{
+    CLIP_VERTEX Tmp[CLIP_MAX_VERTICES];
+
+    for (UINTN p = 0; p < CLIP_PLANES && Count >= 3; p++) {
+        if (!(Planes & (1 << p))) {
+            continue;
+        }
+        CopyMem(Tmp, Poly, Count * sizeof(CLIP_VERTEX));
+        UINTN n = 0;
+        for (UINTN i = 0; i < Count; i++) {
+            CONST CLIP_VERTEX *A = &Tmp[i];
+            CONST CLIP_VERTEX *B = &Tmp[(i + 1) % Count];
+            INT64 Da = clip_distance(A, p);
+            INT64 Db = clip_distance(B, p);
+            if (Da >= 0) {
+                Poly[n++] = *A;
+            }
+            if ((Da >= 0) != (Db >= 0)) {
+                if (Da < 0) {
+                    SWAP(CONST CLIP_VERTEX *, A, B);
+                    SWAP(INT64, Da, Db);
+                }
+                // A inside, B outside
+                INT64 Den = Da - Db;
+                CLIP_VERTEX *V = &Poly[n++];
+                V->X = A->X + DivS64x64Remainder((B->X - A->X) * Da, Den, NULL);
+                V->Y = A->Y + DivS64x64Remainder((B->Y - A->Y) * Da, Den, NULL);
+                V->Z = A->Z + DivS64x64Remainder((B->Z - A->Z) * Da, Den, NULL);
+                V->W = A->W + DivS64x64Remainder((B->W - A->W) * Da, Den, NULL);
+            }
+        }
+        Count = n;
+    }
+    return (Count >= 3) ? Count : 0;
+}
+
+/*
+ * draw_mesh_polygon() - project clipped polygon and fill it as a triangle fan
+ */
+STATIC VOID draw_mesh_polygon(GFX_CONTEXT *Ctx, CONST CLIP_VERTEX *Poly, UINTN Count, UINT32 Colour, UINT32 Flags)
+{
+    INT64 X[CLIP_MAX_VERTICES];
+    INT64 Y[CLIP_MAX_VERTICES];
+    INT64 Z[CLIP_MAX_VERTICES];
+    INT64 Width = (INT64)(Ctx->ClipX1 - Ctx->ClipX0 + 1) * SUBPIXEL_ONE;
+    INT64 Height = (INT64)(Ctx->ClipY1 - Ctx->ClipY0 + 1) * SUBPIXEL_ONE;
+
+    // NDC -1..1 to clip window edges in subpixels, Y down, depth 0..DEPTH_MAX
+    for (UINTN i = 0; i < Count; i++) {
+        CONST CLIP_VERTEX *V = &Poly[i];
+        if (V->W <= 0) {
+            return;
+        }
+        X[i] = (INT64)Ctx->ClipX0 * SUBPIXEL_ONE + DivS64x64Remainder((V->X + V->W) * Width, 2 * V->W, NULL);
+        Y[i] = (INT64)Ctx->ClipY0 * SUBPIXEL_ONE + DivS64x64Remainder((V->W - V->Y) * Height, 2 * V->W, NULL);
+        Z[i] = DivS64x64Remainder((V->Z + V->W) * (DEPTH_MAX >> 1), V->W, NULL);
+        Z[i] = (Z[i] < 0) ? 0 : (Z[i] > DEPTH_MAX) ? DEPTH_MAX : Z[i];
+    }
+    for (UINTN i = 1; i + 1 < Count; i++) {
+        RASTER_TRI Tri;
+        if (!raster_setup(Ctx, &Tri, X[0], Y[0], X[i], Y[i], X[i + 1], Y[i + 1])) {
+            continue;
+        }
+        // front faces are anticlockwise, negative area with Y down so swapped
+        if ((Flags & MESH_CULL_BACK) && !Tri.Swapped) {
+            continue;
+        }
+        if (Flags & MESH_DEPTH_TEST) {
+            DEPTH_INFO Depth;
+            INT64 P[3] = { Z[0], Z[i], Z[i + 1] };
+            Depth.Colour = Colour;
+            Depth.X0 = X[0];
+            Depth.Y0 = Y[0];
+            Depth.Z0 = Z[0];
+            plane_setup(&Tri, P, &Depth.Gx, &Depth.Gy);
+            raster_triangle(Ctx, &Tri, depth_span, &Depth);
+        } else {
+            raster_triangle(Ctx, &Tri, fill_span, &Colour);
+        }
+    }
+}
+
+/*
+ * depth_span() - RASTER_SPAN that fills pixels nearer than the depth buffer using DEPTH_INFO
+ */
+STATIC VOID depth_span(GFX_CONTEXT *Ctx, CONST RASTER_TRI *Tri, INT32 y, INT32 xl, INT32 xr, VOID *Data)
+{
+    (VOID)Tri;  // z comes from DEPTH_INFO's gradients
+    CONST DEPTH_INFO *Depth = Data;
+    INT64 Dx = (INT64)xl * SUBPIXEL_ONE + SUBPIXEL_HALF - Depth->X0;
+    INT64 Dy = (INT64)y * SUBPIXEL_ONE + SUBPIXEL_HALF - Depth->Y0;
+    INT64 Z = Depth->Z0 + ARShiftU64(Depth->Gx * Dx + Depth->Gy * Dy, SUBPIXEL_BITS);
+    INT64 End = Z + Depth->Gx * (xr - xl);
+    UINT32 *ptr = Ctx->RenBuf->PixelData + xl + (y * Ctx->RenBuf->PixPerScnLn);
+    UINT16 *zptr = Ctx->RenBuf->DepthData + xl + (y * Ctx->RenBuf->HorRes);
+    UINT32 *end = ptr + (xr - xl);
+
+    if (Z >= 0 && Z <= DEPTH_MAX && End >= 0 && End <= DEPTH_MAX) {
+        UINT32 z = (UINT32)Z;
+        INT32 Step = (INT32)Depth->Gx;
+        while (ptr <= end) {
+            if ((z >> DEPTH_BITS) < *zptr) {
+                *zptr = (UINT16)(z >> DEPTH_BITS);
+                *ptr = Depth->Colour;
+            }
+            ptr++;
+            zptr++;
+            z += Step;
+        }
+        return;
+    }
+    // rounding takes span just past the near or far plane, clamp every pixel
+    while (ptr <= end) {
+        INT64 c = (Z < 0) ? 0 : (Z > DEPTH_MAX) ? DEPTH_MAX : Z;
+        if ((UINT16)(c >> DEPTH_BITS) < *zptr) {
+            *zptr = (UINT16)(c >> DEPTH_BITS);
+            *ptr = Depth->Colour;
+        }
+        ptr++;
+        zptr++;
+        Z += Depth->Gx;
+    }
+}
+
+VOID DrawRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(x0=%d, y0=%d, x1=%d, y1=%d, colour=0x%08X)\n", __func__, x0, y0, x1, y1, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => 0\n", __func__);
+        return;
+    }
+    draw_rectangle(&gCurrCtx, x0, y0, x1, y1, colour);
+}
+
+VOID CtxDrawRectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, colour);
+
+    if (!check_context(Ctx)) {
+        return;
+    }
+    draw_rectangle(Ctx, x0, y0, x1, y1, colour);
+}
+
+STATIC VOID draw_rectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, colour);
+
+    // determine top-left and bottom-right
+    INT32 xl, xr, yt, yb;
+    if (x0 < x1) {
+        xl = x0;
+        xr = x1;
+    } else {
+        xl = x1;
+        xr = x0;
+    }
+    if (y0 < y1) {
+        yt = y0;
+        yb = y1;
+    } else {
+        yt = y1;
+        yb = y0;
+    }
+    // clip rectamgle
+    if (yb < Ctx->ClipY0 || yt > Ctx->ClipY1 || xr < Ctx->ClipX0 || xl > Ctx->ClipX1) {
+        return;
+    }
+    INT32 width = xr - xl + 1;
+    INT32 height = yb - yt + 1;
+    BOOLEAN left=TRUE, right=TRUE, top=TRUE, bottom=TRUE;
+    if (xl < Ctx->ClipX0) {
+        left = FALSE;
+        xl = Ctx->ClipX0;
+        width = (xr - Ctx->ClipX0 + 1);
+    }
+    if (xr > Ctx->ClipX1) {
+        right = FALSE;
+        width -= (xr - Ctx->ClipX1);
+    }
+    if (yt < Ctx->ClipY0) {
+        top = FALSE;
+        yt = Ctx->ClipY0;
+        height = (yb - Ctx->ClipY0 + 1);
+    }
+    if (yb > Ctx->ClipY1) {
+        bottom = FALSE;
+        height -= (yb - Ctx->ClipY1);
+    }
+    // draw rectangle
+    EDK2SIM_GFX_BEGIN;
+    UINT32 *ptr = Ctx->RenBuf->PixelData + xl + (yt * Ctx->RenBuf->PixPerScnLn);
+    // top line
+    if (top) {
+        SetMem32(ptr, width * sizeof(UINT32), colour);
+        ptr += (width - 1);
+    } else {
+        ptr += (width - 1);
+    }
+    // right line
+    if (right) {
+        INT32 h = height;
+        while (TRUE) {
+            *ptr = colour;
+            h--;
+            if (!h) break;
+            ptr += Ctx->RenBuf->PixPerScnLn;
+        }
+    } else {
+        ptr += (Ctx->RenBuf->PixPerScnLn * (height - 1));
+    }
+    // bottom line 
+    if (bottom) {
+        ptr -= (width - 1);
+        SetMem32(ptr, width * sizeof(UINT32), colour);
+    } else {
+        ptr -= (width - 1);
+    }
+    // left line
+    if (left) {
+        INT32 h = height;
+        while (TRUE) {
+            *ptr = colour;
+            h--;
+            if (!h) break;
+            ptr -= Ctx->RenBuf->PixPerScnLn;
+        }
+    }
+    EDK2SIM_GFX_END;
+}
+
+VOID DrawFillRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(x0=%d, y0=%d, x1=%d, y1=%d, colour=0x%08X)\n", __func__, x0, y0, x1, y1, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => 0\n", __func__);
+        return;
+    }
+    draw_fill_rectangle(&gCurrCtx, x0, y0, x1, y1, colour);
+}
+
+VOID CtxDrawFillRectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, colour);
+
+    if (!check_context(Ctx)) {
+        return;
+    }
+    draw_fill_rectangle(Ctx, x0, y0, x1, y1, colour);
+}
+
+STATIC VOID draw_fill_rectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, colour);
+
+    // determine top-left and bottom-right
+    INT32 xl, xr, yt, yb;
+    if (x0 < x1) {
+        xl = x0;
+        xr = x1;
+    } else {
+        xl = x1;
+        xr = x0;
+    }
+    if (y0 < y1) {
+        yt = y0;
+        yb = y1;
+    } else {
+        yt = y1;
+        yb = y0;
+    }
+    // clip rectamgle
+    if (yb < Ctx->ClipY0 || yt > Ctx->ClipY1 || xr < Ctx->ClipX0 || xl > Ctx->ClipX1) {
+        return;
+    }
+    UINT32 width = xr - xl + 1;
+    UINT32 height = yb - yt + 1;
+    if (xl < Ctx->ClipX0) {
+        xl = Ctx->ClipX0;
+        width = (xr - Ctx->ClipX0 + 1);
+    }
+    if (xr > Ctx->ClipX1) {
+        width -= (xr - Ctx->ClipX1);
+    }
+    if (yt < Ctx->ClipY0) {
+        yt = Ctx->ClipY0;
+        height = (yb - Ctx->ClipY0 + 1);
+    }
+    if (yb > Ctx->ClipY1) {
+        height -= (yb - Ctx->ClipY1);
+    }
+    // draw rectangle    
+    if (Ctx->RenderToScreen) {
+        gGop->Blt(gGop, (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)&colour, EfiBltVideoFill, 0, 0, xl, yt, width, height, 0);
+    } else {        
+        UINT32 *ptr = Ctx->RenBuf->PixelData + xl + (yt * Ctx->RenBuf->PixPerScnLn);
+        if (parallel_fill(ptr, width, height, Ctx->RenBuf->PixPerScnLn, colour)) {
+            return;
+        }
+        while (height--) {
+            SetMem32(ptr, width * sizeof(UINT32), colour);
+            ptr += Ctx->RenBuf->PixPerScnLn;
+        }
+    }
+}
+
+/*
+ * DrawFillRects()
+ */
+
+UINTN DrawFillRects(CONST RECT *Rects, CONST UINT32 *Colours, UINTN Count)
+{
+    DbgPrint(DL_INFO, "%a(Rects=0x%p, Colours=0x%p, Count=%u)\n", __func__, Rects, Colours, Count);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => 0\n", __func__);
+        return 0;
+    }
+    return draw_fill_rects(&gCurrCtx, Rects, Colours, Count);
+}
+
+UINTN CtxDrawFillRects(GFX_CONTEXT *Ctx, CONST RECT *Rects, CONST UINT32 *Colours, UINTN Count)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Rects=0x%p, Colours=0x%p, Count=%u)\n", __func__, Ctx, Rects, Colours, Count);
+
+    if (!check_context(Ctx)) {
+        return 0;
+    }
+    return draw_fill_rects(Ctx, Rects, Colours, Count);
+}
+
+// Batches of rectangles drawn to a buffer are bucketed by band of scanlines
+// and filled a band at a time, so the band's rows stay in cache while every
+// rectangle crossing it is drawn
+#define SORT_RECTS_MIN      32
+#define RECT_BAND_SHIFT     4   // 16 scanlines per band
+
+/*
+ * draw_fill_rects() - fill Rects[i] with Colours[i] in order, return number inside clip window
+ */
+STATIC UINTN draw_fill_rects(GFX_CONTEXT *Ctx, CONST RECT *Rects, CONST UINT32 *Colours, UINTN Count)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Rects=0x%p, Colours=0x%p, Count=%u)\n", __func__, Ctx, Rects, Colours, Count);
+
+    if (!Rects || !Colours || !Count) {
+        return 0;
+    }
+    if (Count >= SORT_RECTS_MIN && !Ctx->RenderToScreen) {
+        UINTN Drawn = draw_sorted_rects(Ctx, Rects, Colours, Count);
+        if (Drawn != MAX_UINTN) {
+            return Drawn;
+        }
+    }
+    UINTN Drawn = 0;
+    RECT Clip;
+
+    EDK2SIM_GFX_BEGIN;
+    for (UINTN i = 0; i < Count; i++) {
+        if (!clip_rect(Ctx, &Rects[i], &Clip)) {
+            continue;
+        }
+        if (Ctx->RenderToScreen) {
+            gGop->Blt(gGop, (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)&Colours[i], EfiBltVideoFill, 0, 0, Clip.X0, Clip.Y0, Clip.X1 - Clip.X0 + 1, Clip.Y1 - Clip.Y0 + 1, 0);
+        } else {
+            UINT32 *Row = Ctx->RenBuf->PixelData + (Clip.Y0 * Ctx->RenBuf->PixPerScnLn);
+            for (INT32 y = Clip.Y0; y <= Clip.Y1; y++) {
+                fill_shape_row(Row, Clip.X0, Clip.X1, Colours[i]);
+                Row += Ctx->RenBuf->PixPerScnLn;
+            }
+        }
+        Drawn++;
+    }
+    EDK2SIM_GFX_END;
+
+    return Drawn;
+}
+
+/*
+ * draw_sorted_rects() - bucket the visible rectangles by the scanline band they start in
+ * (stable counting sort) then fill band by band, returns MAX_UINTN if working memory not
+ * available
+ *
+ * Rectangles crossing the band being filled are kept in call order in an active list, each
+ * is clipped to the band as it is drawn so working memory stays proportional to Count.
+ */
+STATIC UINTN draw_sorted_rects(GFX_CONTEXT *Ctx, CONST RECT *Rects, CONST UINT32 *Colours, UINTN Count)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Rects=0x%p, Colours=0x%p, Count=%u)\n", __func__, Ctx, Rects, Colours, Count);
+
+    if (Count > MAX_UINT32) {
+        return MAX_UINTN;
+    }
+    INT32 ClipY0 = Ctx->ClipY0;
+    UINTN NumBands = ((UINT32)(Ctx->ClipY1 - ClipY0) >> RECT_BAND_SHIFT) + 1;
+    UINTN *Band = AllocateZeroPool((NumBands + 1) * sizeof(UINTN));
+    UINT32 *Order = AllocatePool(Count * sizeof(UINT32));
+    UINT32 *Active = AllocatePool(Count * sizeof(UINT32));
+    if (!Band || !Order || !Active) {
+        DbgPrint(DL_WARN, "%a(), memory allocation error => MAX_UINTN\n", __func__);
+        if (Band) {
+            FreePool(Band);
+        }
+        if (Order) {
+            FreePool(Order);
+        }
+        if (Active) {
+            FreePool(Active);
+        }
+        return MAX_UINTN;
+    }
+    // count the visible rectangles starting in each band
+    RECT Clip;
+    for (UINTN i = 0; i < Count; i++) {
+        if (clip_rect(Ctx, &Rects[i], &Clip)) {
+            Band[((UINT32)(Clip.Y0 - ClipY0) >> RECT_BAND_SHIFT) + 1]++;
+        }
+    }
+    for (UINTN b = 1; b <= NumBands; b++) {
+        Band[b] += Band[b - 1];
+    }
+    UINTN Drawn = Band[NumBands];
+    // order rectangle indices by start band, leaving Band[b] at the end of band b
+    for (UINTN i = 0; i < Count; i++) {
+        if (clip_rect(Ctx, &Rects[i], &Clip)) {
+            Order[Band[(UINT32)(Clip.Y0 - ClipY0) >> RECT_BAND_SHIFT]++] = (UINT32)i;
+        }
+    }
+    UINT32 *base = Ctx->RenBuf->PixelData;
+    INT32 PixPerScnLn = Ctx->RenBuf->PixPerScnLn;
+    UINTN NumActive = 0;
+    UINTN Start = 0;
+
+    EDK2SIM_GFX_BEGIN;
+    for (UINTN b = 0; b < NumBands; b++) {
+        // merge the rectangles starting in this band into the active list from the end
+        UINTN a = NumActive;
+        UINTN s = Band[b];
+        UINTN k = NumActive + (Band[b] - Start);
+        NumActive = k;
+        while (s > Start) {
+            if (a > 0 && Active[a - 1] > Order[s - 1]) {
+                Active[--k] = Active[--a];
+            } else {
+                Active[--k] = Order[--s];
+            }
+        }
+        Start = Band[b];
+        INT32 Top = ClipY0 + (INT32)(b << RECT_BAND_SHIFT);
+        INT32 Bottom = Top + (1 << RECT_BAND_SHIFT) - 1;
+        UINTN Kept = 0;
+        for (UINTN n = 0; n < NumActive; n++) {
+            UINT32 i = Active[n];
+            clip_rect(Ctx, &Rects[i], &Clip);
+            UINT32 *Row = base + (MAX(Clip.Y0, Top) * PixPerScnLn);
+            for (INT32 y = MAX(Clip.Y0, Top); y <= MIN(Clip.Y1, Bottom); y++) {
+                fill_shape_row(Row, Clip.X0, Clip.X1, Colours[i]);
+                Row += PixPerScnLn;
+            }
+            if (Clip.Y1 > Bottom) {
+                // still crosses the next band
+                Active[Kept++] = i;
+            }
+        }
+        NumActive = Kept;
+    }
+    EDK2SIM_GFX_END;
+
+    FreePool(Band);
+    FreePool(Order);
+    FreePool(Active);
+
+    return Drawn;
+}
+
+/*
+ * clip_rect() - corners of Rect put in order and clipped to Clip, FALSE if none of it is visible
+ */
+STATIC BOOLEAN clip_rect(CONST GFX_CONTEXT *Ctx, CONST RECT *Rect, RECT *Clip)
+{
+    Clip->X0 = MAX(MIN(Rect->X0, Rect->X1), Ctx->ClipX0);
+    Clip->X1 = MIN(MAX(Rect->X0, Rect->X1), Ctx->ClipX1);
+    Clip->Y0 = MAX(MIN(Rect->Y0, Rect->Y1), Ctx->ClipY0);
+    Clip->Y1 = MIN(MAX(Rect->Y0, Rect->Y1), Ctx->ClipY1);
+
+    return (Clip->X0 <= Clip->X1) && (Clip->Y0 <= Clip->Y1);
+}
+
+/*
+ * DrawCircle()
+ */
+
+VOID DrawCircle(INT32 xc, INT32 yc, INT32 r, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(xc=%d, yc=%d, r=%d, colour=0x%08X)\n", __func__, xc, yc, r, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => 0\n", __func__);
+        return;
+    }
+    draw_circle(&gCurrCtx, xc, yc, r, colour);
+}
+
+VOID CtxDrawCircle(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 r, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, xc=%d, yc=%d, r=%d, colour=0x%08X)\n", __func__, Ctx, xc, yc, r, colour);
+
+    if (!check_context(Ctx)) {
+        return;
+    }
+    draw_circle(Ctx, xc, yc, r, colour);
+}
+
+STATIC VOID draw_circle(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 r, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, xc=%d, yc=%d, r=%d, colour=0x%08X)\n", __func__, Ctx, xc, yc, r, colour);
+
+#if CIRCLE_OPTIMISATION
+    if (draw_full_circle(Ctx, xc, yc, r, colour)) {
+        // full circle was drawn
+        return;
+    }
+#endif
+    // draw_full_circle() returned FALSE!
+    draw_part_circle(Ctx, xc, yc, r, colour);
+}
+
+/*
+ * draw_part_circle() - draw a clipped circle one octant at a time
+ *
+ * Plots the same pixels as the midpoint loop in draw_full_circle() restricted to the clip
+ * rectangle, each octant only walks the steps that land inside it.
+ */
+STATIC VOID draw_part_circle(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 r, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, xc=%d, yc=%d, r=%d, colour=0x%08X)\n", __func__, Ctx, xc, yc, r, colour);
+
+    INT64 Extent = MAX(ABS((INT64)r), 1);  // r = 0 still steps once to distance 1
+    UINT32 Octant;
+
+    if ((INT64)xc + Extent < Ctx->ClipX0 || (INT64)xc - Extent > Ctx->ClipX1 ||
+        (INT64)yc + Extent < Ctx->ClipY0 || (INT64)yc - Extent > Ctx->ClipY1) {
+        // circle is outside the clip rectangle
+        return;
+    }
+
+    EDK2SIM_GFX_BEGIN;
+    for (Octant = 0; Octant < 8; Octant++) {
+        draw_circle_octant(Ctx, xc, yc, r, (Octant & 1) ? -1 : 1, (Octant & 2) ? -1 : 1, (BOOLEAN)((Octant & 4) != 0), colour);
+    }
+    EDK2SIM_GFX_END;
+}
+
+/*
+ * circle_y() - y of step i of the midpoint loop (x == i)
+ *
+ * The decision variable after step i is d = 2i^2 + 8i + 2y^2 - 6y + 3 + 4r - 2r^2 and y drops
+ * whenever d > 0, so while the octant slope is under 1 y is the largest value with
+ * 2y^2 - 6y <= 2r^2 - 4r - 3 - 2(i - 1)^2 - 8(i - 1). Exact for i <= isqrt(r^2 / 2) - 1.
+ */
+STATIC INT64 circle_y(INT64 r, INT64 i)
+{
+    INT64 j = i - 1;
+    INT64 M;
+
+    if (i == 0) {
+        return r;
+    }
+    M = 2 * ((r * r) - (j * j)) - (4 * r) - (8 * j) - 3;
+    return ((INT64)isqrt64(((UINT64)M << 1) + 9) + 3) >> 1;
+}
+
+/*
+ * circle_step() - first step of the midpoint loop with y <= yMax, from the inverse of circle_y()
+ */
+STATIC INT64 circle_step(INT64 r, INT64 yMax)
+{
+    INT64 A;
+    INT64 K;
+
+    if (yMax >= r) {
+        return 0;
+    }
+    if (yMax < 1) {
+        return MAX_INT64;
+    }
+    A = yMax + 1;
+    K = 2 * ((r * r) - (A * A)) - (4 * r) + (6 * A) - 3;
+    return (K + 8 < 0) ? 1 : MAX((INT64)isqrt64((UINT64)(K + 8) >> 1) - 1, 0) + 1;
+}
+
+/*
+ * circle_seed() - y and decision variable of the midpoint loop at step i, returns the step used
+ *
+ * circle_y() is exact up to Safe so later steps are seeded there, the caller walks the
+ * loop on from the step returned.
+ */
+STATIC INT64 circle_seed(INT64 r, INT64 i, INT64 *y, INT64 *d)
+{
+    INT64 Safe = MAX((INT64)isqrt64((UINT64)(r * r) >> 1) - 2, 0);
+
+    i = MIN(i, Safe);
+    if (i == 0) {
+        *y = r;
+        *d = 3 - 2 * r;
+    } else {
+        *y = circle_y(r, i);
+        *d = 2 * ((i * i) - (r * r) + (*y * *y)) + (8 * i) - (6 * *y) + (4 * r) + 3;
+    }
+    return i;
+}
+
+/*
+ * draw_circle_octant() - draw the clipped part of one octant of a midpoint circle
+ *
+ * Step i of the midpoint loop is (x, y) = (i, y(i)) with y never increasing, the octant
+ * plots (xc + Sx * x, yc + Sy * y) or with Swap (xc + Sx * y, yc + Sy * x). Clipping i and
+ * y to the clip rectangle gives one interval of steps, the loop is seeded at its first step
+ * from circle_y() and writes through a pointer with no per-pixel clip test.
+ */
+STATIC VOID draw_circle_octant(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 r, INT32 Sx, INT32 Sy, BOOLEAN Swap, UINT32 colour)
+{
+    INT64 Lo[2];
+    INT64 Hi[2];
+    INT64 i;
+    INT64 y;
+    INT64 d;
+    INT64 Pitch = Ctx->RenBuf->PixPerScnLn;
+    INT64 StepI;
+    INT64 StepY;
+    UINT32 *ptr;
+
+    // ranges of the octant's x and y offsets that are inside the clip rectangle
+    Lo[0] = (Sx > 0) ? (INT64)Ctx->ClipX0 - xc : (INT64)xc - Ctx->ClipX1;
+    Hi[0] = (Sx > 0) ? (INT64)Ctx->ClipX1 - xc : (INT64)xc - Ctx->ClipX0;
+    Lo[1] = (Sy > 0) ? (INT64)Ctx->ClipY0 - yc : (INT64)yc - Ctx->ClipY1;
+    Hi[1] = (Sy > 0) ? (INT64)Ctx->ClipY1 - yc : (INT64)yc - Ctx->ClipY0;
+
+    // [Lo[Swap], Hi[Swap]] limits i, [Lo[!Swap], Hi[!Swap]] limits y
+    INT64 iLo = MAX(Lo[Swap], 0);
+    INT64 iHi = Hi[Swap];
+    INT64 yLo = Lo[!Swap];
+    INT64 yHi = Hi[!Swap];
+
+    if (iLo > iHi || yLo > yHi || yLo > r) {
+        return;
+    }
+
+    // seed at the first step with y <= yHi and i >= iLo, then walk to it
+    i = circle_seed(r, MAX(circle_step(r, yHi), iLo), &y, &d);
+    while (i < iLo || y > yHi) {
+        if (y < i) {
+            return;
+        }
+        i++;
+        if (d > 0) {
+            y--;
+            d = d + 4 * (i - y) + 10;
+        } else {
+            d = d + 4 * i + 6;
+        }
+    }
+    if (i > iHi || y < yLo) {
+        return;
+    }
+
+    if (Swap) {
+        ptr = Ctx->RenBuf->PixelData + xc + (Sx * y) + ((yc + (Sy * i)) * Pitch);
+        StepI = Sy * Pitch;
+        StepY = -Sx;
+    } else {
+        ptr = Ctx->RenBuf->PixelData + xc + (Sx * i) + ((yc + (Sy * y)) * Pitch);
+        StepI = Sx;
+        StepY = -Sy * Pitch;
+    }
+
+    for (;;) {
+        *ptr = colour;
+        if (y < i || i == iHi) {
+            break;
+        }
+        i++;
+        ptr += StepI;
+        if (d > 0) {
+            y--;
+            if (y < yLo) {
+                break;
+            }
+            ptr += StepY;
+            d = d + 4 * (i - y) + 10;
+        } else {
+            d = d + 4 * i + 6;
+        }
+    }
+}
+
+#if CIRCLE_OPTIMISATION
+/*
+ * draw_full_circle() - return TRUE if circle drawn
+ */
+STATIC BOOLEAN draw_full_circle(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 r, UINT32 colour)
+{
+    INT32 x = 0;
+    INT32 y = r;
+    INT32 d = 3 - 2 * r;
+
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, xc=%d, yc=%d, r=%d, colour=0x%08X)\n", __func__, Ctx, xc, yc, r, colour);
+
+    if (r < 1 || Ctx->ClipX0 + r > xc || Ctx->ClipX1 < xc + r || Ctx->ClipY0 + r > yc || Ctx->ClipY1 < yc + r) {
+        // circle is clipped (or degenerate and stepping past r) so exit
+        return FALSE;
+    }
+
+    // (xc + x, yc + y)
+    UINT32 *ptr_br = Ctx->RenBuf->PixelData + xc + x + ((yc + y) * Ctx->RenBuf->PixPerScnLn);
+    *ptr_br = colour;
+    // (xc - x, yc + y)
+    UINT32 *ptr_bl = ptr_br;
+    *ptr_br = colour;
+    // (xc + x, yc - y)
+    UINT32 *ptr_tr = Ctx->RenBuf->PixelData + xc + x + ((yc - y) * Ctx->RenBuf->PixPerScnLn);
+    *ptr_tr = colour;
     // (xc - x, yc - y)
     UINT32 *ptr_tl = ptr_tr;
     *ptr_tl = colour;
     // (xc + y, yc + x)
-    UINT32 *ptr_rd = gCurrRenBuf->PixelData + xc + y + ((yc + x) * gCurrRenBuf->PixPerScnLn);
+    UINT32 *ptr_rd = Ctx->RenBuf->PixelData + xc + y + ((yc + x) * Ctx->RenBuf->PixPerScnLn);
     *ptr_rd = colour;
     // (xc - y, yc + x)
-    UINT32 *ptr_ld = gCurrRenBuf->PixelData + xc - y + ((yc + x) * gCurrRenBuf->PixPerScnLn);
+    UINT32 *ptr_ld = Ctx->RenBuf->PixelData + xc - y + ((yc + x) * Ctx->RenBuf->PixPerScnLn);
     *ptr_ld = colour;
     // (xc + y, yc - x)
     UINT32 *ptr_ru = ptr_rd;
@@ -1235,76 +3883,3098 @@ STATIC BOOLEAN draw_full_circle(INT32 xc, INT32 yc, INT32 r, UINT32 colour)
     *ptr_ru = colour;
 
     EDK2SIM_GFX_BEGIN;
-    while (y >= x) {
-        x++;
-        ptr_br++;
-        ptr_bl--;
-        ptr_tr++;
-        ptr_tl--;
-        ptr_rd += gCurrRenBuf->PixPerScnLn;
-        ptr_ld += gCurrRenBuf->PixPerScnLn;
-        ptr_ru -= gCurrRenBuf->PixPerScnLn;
-        ptr_lu -= gCurrRenBuf->PixPerScnLn;
+    while (y >= x) {
+        x++;
+        ptr_br++;
+        ptr_bl--;
+        ptr_tr++;
+        ptr_tl--;
+        ptr_rd += Ctx->RenBuf->PixPerScnLn;
+        ptr_ld += Ctx->RenBuf->PixPerScnLn;
+        ptr_ru -= Ctx->RenBuf->PixPerScnLn;
+        ptr_lu -= Ctx->RenBuf->PixPerScnLn;
+
+        if (d > 0) {
+            y--;
+            ptr_br -= Ctx->RenBuf->PixPerScnLn;
+            ptr_bl -= Ctx->RenBuf->PixPerScnLn;
+            ptr_tr += Ctx->RenBuf->PixPerScnLn;
+            ptr_tl += Ctx->RenBuf->PixPerScnLn;
+            ptr_rd--;
+            ptr_ld++;
+            ptr_ru--;
+            ptr_lu++;
+
+            d = d + 4 * (x - y) + 10;
+        } else {
+            d = d + 4 * x + 6;
+        }
+        
+        *ptr_br = colour;   // (xc + x, yc + y)
+        *ptr_bl = colour;   // (xc - x, yc + y)
+        *ptr_tr = colour;   // (xc + x, yc - y)
+        *ptr_tl = colour;   // (xc - x, yc - y)
+        *ptr_rd = colour;   // (xc + y, yc + x)
+        *ptr_ld = colour;   // (xc - y, yc + x)
+        *ptr_ru = colour;   // (xc + y, yc - x)
+        *ptr_lu = colour;   // (xc - y, yc - x)
+    }
+    EDK2SIM_GFX_END;
+
+    return TRUE;
+}
+#endif
+
+VOID DrawFillCircle(INT32 xc, INT32 yc, INT32 r, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(xc=%d, yc=%d, r=%d, colour=0x%08X)\n", __func__, xc, yc, r, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => 0\n", __func__);
+        return;
+    }
+    draw_fill_circle(&gCurrCtx, xc, yc, r, colour, NULL);
+}
+
+VOID CtxDrawFillCircle(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 r, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, xc=%d, yc=%d, r=%d, colour=0x%08X)\n", __func__, Ctx, xc, yc, r, colour);
+
+    if (!check_context(Ctx)) {
+        return;
+    }
+    draw_fill_circle(Ctx, xc, yc, r, colour, NULL);
+}
+
+/*
+ * draw_fill_circle() - fill a midpoint circle with one span per row
+ *
+ * Step (x, y) of the midpoint loop gives the middle rows yc +/- x with half width y and,
+ * when y is about to drop, the outer rows yc +/- y with half width x. Outer rows stay above
+ * the last step's x except when the loop ends on x == y, which the middle row has drawn.
+ * Only the steps between the first and last visible row offsets are walked.
+ */
+STATIC VOID draw_fill_circle(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 r, UINT32 colour, CONST BRUSH *Brush)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, xc=%d, yc=%d, r=%d, colour=0x%08X, Brush=0x%p)\n", __func__, Ctx, xc, yc, r, colour, Brush);
+
+    INT64 x;
+    INT64 y;
+    INT64 d;
+
+    if ((INT64)xc + r < Ctx->ClipX0 || (INT64)xc - r > Ctx->ClipX1 || (INT64)yc + r < Ctx->ClipY0 || (INT64)yc - r > Ctx->ClipY1) {
+        // circle is outside the clip rectangle
+        return;
+    }
+    // visible row offsets from yc, middle rows are at x and outer rows at y
+    INT64 Lo = MAX(MAX((INT64)Ctx->ClipY0 - yc, (INT64)yc - Ctx->ClipY1), 0);
+    INT64 Hi = MAX((INT64)Ctx->ClipY1 - yc, (INT64)yc - Ctx->ClipY0);
+
+    x = circle_seed(r, MIN(Lo, circle_step(r, Hi)), &y, &d);
+
+    EDK2SIM_GFX_BEGIN;
+    while (y >= x && x <= Hi && y >= Lo) {
+        draw_mirrored_span(Ctx, xc, yc, xc, yc, x, y, colour, Brush);      // middle
+        if (d > 0) {
+            if (y > x) {
+                draw_mirrored_span(Ctx, xc, yc, xc, yc, y, x, colour, Brush);  // outer
+            }
+            x++;
+            y--;
+            d = d + 4 * (x - y) + 10;
+        } else {
+            x++;
+            d = d + 4 * x + 6;
+        }
+    }
+    EDK2SIM_GFX_END;
+}
+
+/*
+ * draw_mirrored_span() - fill rows y0 - dy and y1 + dy from x0 - HalfWidth to x1 + HalfWidth, with colour or Brush
+ */
+STATIC VOID draw_mirrored_span(GFX_CONTEXT *Ctx, INT64 x0, INT64 y0, INT64 x1, INT64 y1, INT64 dy, INT64 HalfWidth, UINT32 colour, CONST BRUSH *Brush)
+{
+    INT64 xl = MAX(x0 - HalfWidth, Ctx->ClipX0);
+    INT64 xr = MIN(x1 + HalfWidth, Ctx->ClipX1);
+    INT64 y;
+
+    if (xl > xr) {
+        return;
+    }
+    y = y0 - dy;
+    if (y >= Ctx->ClipY0 && y <= Ctx->ClipY1 && Brush) {
+        brush_span(Brush, Ctx->RenBuf->PixelData + (y * Ctx->RenBuf->PixPerScnLn), xl, xr, y);
+    } else if (y >= Ctx->ClipY0 && y <= Ctx->ClipY1) {
+        SetMem32(Ctx->RenBuf->PixelData + xl + (y * Ctx->RenBuf->PixPerScnLn), (UINTN)(xr - xl + 1) * sizeof(UINT32), colour);
+    }
+    if (y1 + dy == y0 - dy) {
+        return;
+    }
+    y = y1 + dy;
+    if (y >= Ctx->ClipY0 && y <= Ctx->ClipY1 && Brush) {
+        brush_span(Brush, Ctx->RenBuf->PixelData + (y * Ctx->RenBuf->PixPerScnLn), xl, xr, y);
+    } else if (y >= Ctx->ClipY0 && y <= Ctx->ClipY1) {
+        SetMem32(Ctx->RenBuf->PixelData + xl + (y * Ctx->RenBuf->PixPerScnLn), (UINTN)(xr - xl + 1) * sizeof(UINT32), colour);
+    }
+}
+
+/*
+ * ellipse_half_width() - half width of row v of the ellipse, -1 past its top, v must not decrease between calls
+ */
+STATIC INT64 ellipse_half_width(ELLIPSE_ROWS *Rows, INT64 v)
+{
+    if (v > Rows->Ry) {
+        return -1;
+    }
+    UINT64 Rhs = Rows->A2 * (Rows->B2 - 4 * (UINT64)(v * v));
+    if (Rows->V < 0) {
+        Rows->U = DivU64x32(isqrt64(Rhs), (UINT32)(2 * Rows->Ry + 1)) >> 1;
+    }
+    while (4 * Rows->U * Rows->U * Rows->B2 > Rhs) {
+        Rows->U--;
+    }
+    Rows->V = v;
+    return (INT64)Rows->U;
+}
+
+/*
+ * init_round_shape() - shape for the box [x0, x1] x [y0, y1] grown by radii rx, ry, FALSE if it is not visible
+ */
+STATIC BOOLEAN init_round_shape(GFX_CONTEXT *Ctx, ROUND_SHAPE *Shape, INT64 x0, INT64 y0, INT64 x1, INT64 y1, INT32 rx, INT32 ry, CONST SECTOR *Sector)
+{
+    Shape->X0 = x0;
+    Shape->Y0 = y0;
+    Shape->X1 = x1;
+    Shape->Y1 = y1;
+    Shape->Rx = rx;
+    Shape->Ry = ry;
+    Shape->Sector = Sector;
+    if (x1 + rx < Ctx->ClipX0 || x0 - rx > Ctx->ClipX1 || y1 + ry < Ctx->ClipY0 || y0 - ry > Ctx->ClipY1) {
+        return FALSE;
+    }
+    Shape->Clip = (x0 - rx < Ctx->ClipX0 || x1 + rx > Ctx->ClipX1 || y0 - ry < Ctx->ClipY0 || y1 + ry > Ctx->ClipY1);
+    return TRUE;
+}
+
+/*
+ * clip_half_plane() - limit [*Lo, *Hi] to the u with c0 + c1 * u >= 0
+ */
+STATIC VOID clip_half_plane(INT64 c0, INT64 c1, INT64 *Lo, INT64 *Hi)
+{
+    INT64 r;
+
+    if (c1 > 0) {
+        *Lo = MAX(*Lo, -floor_div(c0, c1, &r));
+    } else if (c1 < 0) {
+        *Hi = MIN(*Hi, floor_div(c0, -c1, &r));
+    } else if (c0 < 0) {
+        *Hi = *Lo - 1;
+    }
+}
+
+/*
+ * draw_shape_span() - fill [x0, x1] of row y that is in the clip rectangle and the shape's sector
+ */
+STATIC VOID draw_shape_span(GFX_CONTEXT *Ctx, CONST ROUND_SHAPE *Shape, INT64 y, INT64 x0, INT64 x1, UINT32 colour)
+{
+    UINT32 *Row;
+
+    if (Shape->Clip) {
+        if (y < Ctx->ClipY0 || y > Ctx->ClipY1) {
+            return;
+        }
+        x0 = MAX(x0, Ctx->ClipX0);
+        x1 = MIN(x1, Ctx->ClipX1);
+    }
+    Row = Ctx->RenBuf->PixelData + (y * Ctx->RenBuf->PixPerScnLn);
+
+    if (Shape->Sector) {
+        // p = (u, dy) is clockwise from S when S x p >= 0 and before E when p x E >= 0
+        CONST SECTOR *Sector = Shape->Sector;
+        INT64 dy = y - Shape->Y0;
+        INT64 Lo = x0 - Shape->X0;
+        INT64 Hi = x1 - Shape->X0;
+
+        if (Hi - Lo < SHAPE_SETMEM_MIN) {
+            // short (outline) span, test each pixel rather than divide for the edges
+            for (; Lo <= Hi; Lo++) {
+                BOOLEAN After = (Sector->Cs * dy - Sector->Ss * Lo >= 0);
+                BOOLEAN Before = (Lo * Sector->Se - dy * Sector->Ce >= 0);
+                if (Sector->Reflex ? (After || Before) : (After && Before)) {
+                    Row[Shape->X0 + Lo] = colour;
+                }
+            }
+            return;
+        }
+        if (!Sector->Reflex) {
+            clip_half_plane(Sector->Cs * dy, -Sector->Ss, &Lo, &Hi);
+            clip_half_plane(-dy * Sector->Ce, Sector->Se, &Lo, &Hi);
+        } else {
+            // all but the opposite wedge where both are negative
+            INT64 WedgeLo = Lo;
+            INT64 WedgeHi = Hi;
+            clip_half_plane(-Sector->Cs * dy - 1, Sector->Ss, &WedgeLo, &WedgeHi);
+            clip_half_plane(dy * Sector->Ce - 1, -Sector->Se, &WedgeLo, &WedgeHi);
+            if (WedgeLo <= WedgeHi) {
+                fill_shape_row(Row, Shape->X0 + Lo, Shape->X0 + WedgeLo - 1, colour);
+                Lo = WedgeHi + 1;
+            }
+        }
+        x0 = Shape->X0 + Lo;
+        x1 = Shape->X0 + Hi;
+    }
+    fill_shape_row(Row, x0, x1, colour);
+}
+
+/*
+ * fill_shape_row() - set Row[x0..x1], outlines are mostly a few pixels a row so short spans skip SetMem32()
+ */
+STATIC VOID fill_shape_row(UINT32 *Row, INT64 x0, INT64 x1, UINT32 colour)
+{
+    if (x1 - x0 >= SHAPE_SETMEM_MIN) {
+        SetMem32(Row + x0, (UINTN)(x1 - x0 + 1) * sizeof(UINT32), colour);
+        return;
+    }
+    for (; x0 <= x1; x0++) {
+        Row[x0] = colour;
+    }
+}
+
+/*
+ * draw_outline_row() - draw the edge pixels of row y, half width HalfWidth next to a row of NextWidth (-1 none)
+ */
+STATIC VOID draw_outline_row(GFX_CONTEXT *Ctx, CONST ROUND_SHAPE *Shape, INT64 y, INT64 HalfWidth, INT64 NextWidth, UINT32 colour)
+{
+    INT64 Inner = MIN(NextWidth + 1, HalfWidth);
+
+    if (NextWidth < 0 || Shape->X0 - Inner + 1 >= Shape->X1 + Inner) {
+        draw_shape_span(Ctx, Shape, y, Shape->X0 - HalfWidth, Shape->X1 + HalfWidth, colour);
+        return;
+    }
+    draw_shape_span(Ctx, Shape, y, Shape->X0 - HalfWidth, Shape->X0 - Inner, colour);
+    draw_shape_span(Ctx, Shape, y, Shape->X1 + Inner, Shape->X1 + HalfWidth, colour);
+}
+
+/*
+ * draw_round_shape() - fill or outline a ROUND_SHAPE one row at a time
+ *
+ * Rows Y0 - v and Y1 + v share the ellipse's half width of row v, rows between them have
+ * half width Rx. The outline is the shape's pixels with a 4-neighbour outside it: the ends
+ * of each row plus the part not covered by the next row out.
+ */
+STATIC VOID draw_round_shape(GFX_CONTEXT *Ctx, CONST ROUND_SHAPE *Shape, BOOLEAN Fill, UINT32 colour)
+{
+    ELLIPSE_ROWS Rows;
+    INT64 v0 = 0;
+    INT64 v1 = Shape->Ry;
+    INT64 ya = Shape->Y0 + 1;
+    INT64 yb = Shape->Y1 - 1;
+    INT64 v;
+    INT64 y;
+
+    Rows.A2 = (UINT64)(2 * Shape->Rx + 1) * (2 * Shape->Rx + 1);
+    Rows.B2 = (UINT64)(2 * Shape->Ry + 1) * (2 * Shape->Ry + 1);
+    Rows.Ry = Shape->Ry;
+    Rows.V = -1;
+    if (Shape->Clip) {
+        v0 = MAX(MIN(Shape->Y0 - Ctx->ClipY1, Ctx->ClipY0 - Shape->Y1), 0);
+        v1 = MIN(MAX(Shape->Y0 - Ctx->ClipY0, Ctx->ClipY1 - Shape->Y1), Shape->Ry);
+        ya = MAX(ya, Ctx->ClipY0);
+        yb = MIN(yb, Ctx->ClipY1);
+    }
+
+    EDK2SIM_GFX_BEGIN;
+    for (v = v0; v <= v1; v++) {
+        INT64 HalfWidth = ellipse_half_width(&Rows, v);
+        if (Fill && !Shape->Sector) {
+            draw_mirrored_span(Ctx, Shape->X0, Shape->Y0, Shape->X1, Shape->Y1, v, HalfWidth, colour, NULL);
+        } else if (Fill) {
+            draw_shape_span(Ctx, Shape, Shape->Y0 - v, Shape->X0 - HalfWidth, Shape->X1 + HalfWidth, colour);
+            if (Shape->Y1 + v != Shape->Y0 - v) {
+                draw_shape_span(Ctx, Shape, Shape->Y1 + v, Shape->X0 - HalfWidth, Shape->X1 + HalfWidth, colour);
+            }
+        } else {
+            INT64 NextWidth = ellipse_half_width(&Rows, v + 1);
+            draw_outline_row(Ctx, Shape, Shape->Y0 - v, HalfWidth, NextWidth, colour);
+            if (Shape->Y1 + v != Shape->Y0 - v) {
+                draw_outline_row(Ctx, Shape, Shape->Y1 + v, HalfWidth, NextWidth, colour);
+            }
+        }
+    }
+    for (y = ya; y <= yb; y++) {
+        if (Fill) {
+            draw_shape_span(Ctx, Shape, y, Shape->X0 - Shape->Rx, Shape->X1 + Shape->Rx, colour);
+        } else {
+            draw_outline_row(Ctx, Shape, y, Shape->Rx, Shape->Rx, colour);
+        }
+    }
+    EDK2SIM_GFX_END;
+}
+
+/*
+ * DrawEllipse() - outline of the ellipse DrawFillEllipse() fills
+ */
+EFI_STATUS DrawEllipse(INT32 xc, INT32 yc, INT32 rx, INT32 ry, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(xc=%d, yc=%d, rx=%d, ry=%d, colour=0x%08X)\n", __func__, xc, yc, rx, ry, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_ellipse(&gCurrCtx, xc, yc, rx, ry, FALSE, colour);
+}
+
+EFI_STATUS CtxDrawEllipse(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 rx, INT32 ry, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, xc=%d, yc=%d, rx=%d, ry=%d, colour=0x%08X)\n", __func__, Ctx, xc, yc, rx, ry, colour);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_ellipse(Ctx, xc, yc, rx, ry, FALSE, colour);
+}
+
+/*
+ * DrawFillEllipse() - fill the ellipse with radii rx, ry centred on (xc, yc)
+ *
+ * Pixel (xc + u, yc + v) is inside when (u / (rx + 1/2))^2 + (v / (ry + 1/2))^2 <= 1, for
+ * rx == ry that is u^2 + v^2 <= r^2 + r. Radii are limited to ELLIPSE_MAX_RADIUS.
+ */
+EFI_STATUS DrawFillEllipse(INT32 xc, INT32 yc, INT32 rx, INT32 ry, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(xc=%d, yc=%d, rx=%d, ry=%d, colour=0x%08X)\n", __func__, xc, yc, rx, ry, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_ellipse(&gCurrCtx, xc, yc, rx, ry, TRUE, colour);
+}
+
+EFI_STATUS CtxDrawFillEllipse(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 rx, INT32 ry, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, xc=%d, yc=%d, rx=%d, ry=%d, colour=0x%08X)\n", __func__, Ctx, xc, yc, rx, ry, colour);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_ellipse(Ctx, xc, yc, rx, ry, TRUE, colour);
+}
+
+STATIC EFI_STATUS draw_ellipse(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 rx, INT32 ry, BOOLEAN Fill, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, xc=%d, yc=%d, rx=%d, ry=%d, Fill=%d, colour=0x%08X)\n", __func__, Ctx, xc, yc, rx, ry, Fill, colour);
+
+    ROUND_SHAPE Shape;
+
+    if (rx < 0 || ry < 0 || rx > ELLIPSE_MAX_RADIUS || ry > ELLIPSE_MAX_RADIUS) {
+        DbgPrint(DL_ERROR, "%a(), radius out of range => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    if (init_round_shape(Ctx, &Shape, xc, yc, xc, yc, rx, ry, NULL)) {
+        draw_round_shape(Ctx, &Shape, Fill, colour);
+    }
+    return EFI_SUCCESS;
+}
+
+/*
+ * DrawArc() - part of DrawEllipse() clockwise from StartAngle to EndAngle
+ */
+EFI_STATUS DrawArc(INT32 xc, INT32 yc, INT32 rx, INT32 ry, INT32 StartAngle, INT32 EndAngle, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(xc=%d, yc=%d, rx=%d, ry=%d, StartAngle=%d, EndAngle=%d, colour=0x%08X)\n", __func__, xc, yc, rx, ry, StartAngle, EndAngle, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_arc(&gCurrCtx, xc, yc, rx, ry, StartAngle, EndAngle, ARC_OUTLINE, colour);
+}
+
+EFI_STATUS CtxDrawArc(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 rx, INT32 ry, INT32 StartAngle, INT32 EndAngle, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, xc=%d, yc=%d, rx=%d, ry=%d, StartAngle=%d, EndAngle=%d, colour=0x%08X)\n", __func__, Ctx, xc, yc, rx, ry, StartAngle, EndAngle, colour);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_arc(Ctx, xc, yc, rx, ry, StartAngle, EndAngle, ARC_OUTLINE, colour);
+}
+
+/*
+ * DrawPie() - DrawArc() closed by lines to the centre
+ */
+EFI_STATUS DrawPie(INT32 xc, INT32 yc, INT32 rx, INT32 ry, INT32 StartAngle, INT32 EndAngle, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(xc=%d, yc=%d, rx=%d, ry=%d, StartAngle=%d, EndAngle=%d, colour=0x%08X)\n", __func__, xc, yc, rx, ry, StartAngle, EndAngle, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_arc(&gCurrCtx, xc, yc, rx, ry, StartAngle, EndAngle, ARC_PIE, colour);
+}
+
+EFI_STATUS CtxDrawPie(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 rx, INT32 ry, INT32 StartAngle, INT32 EndAngle, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, xc=%d, yc=%d, rx=%d, ry=%d, StartAngle=%d, EndAngle=%d, colour=0x%08X)\n", __func__, Ctx, xc, yc, rx, ry, StartAngle, EndAngle, colour);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_arc(Ctx, xc, yc, rx, ry, StartAngle, EndAngle, ARC_PIE, colour);
+}
+
+/*
+ * DrawFillPie() - pixels of DrawFillEllipse() in the sector clockwise from StartAngle to EndAngle
+ */
+EFI_STATUS DrawFillPie(INT32 xc, INT32 yc, INT32 rx, INT32 ry, INT32 StartAngle, INT32 EndAngle, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(xc=%d, yc=%d, rx=%d, ry=%d, StartAngle=%d, EndAngle=%d, colour=0x%08X)\n", __func__, xc, yc, rx, ry, StartAngle, EndAngle, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_arc(&gCurrCtx, xc, yc, rx, ry, StartAngle, EndAngle, ARC_FILL_PIE, colour);
+}
+
+EFI_STATUS CtxDrawFillPie(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 rx, INT32 ry, INT32 StartAngle, INT32 EndAngle, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, xc=%d, yc=%d, rx=%d, ry=%d, StartAngle=%d, EndAngle=%d, colour=0x%08X)\n", __func__, Ctx, xc, yc, rx, ry, StartAngle, EndAngle, colour);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_arc(Ctx, xc, yc, rx, ry, StartAngle, EndAngle, ARC_FILL_PIE, colour);
+}
+
+/*
+ * draw_arc() - arc, pie or filled pie of the ellipse, a sweep of a whole turn or more is all of it
+ */
+STATIC EFI_STATUS draw_arc(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 rx, INT32 ry, INT32 StartAngle, INT32 EndAngle, UINT32 Kind, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, xc=%d, yc=%d, rx=%d, ry=%d, StartAngle=%d, EndAngle=%d, Kind=%u, colour=0x%08X)\n", __func__, Ctx, xc, yc, rx, ry, StartAngle, EndAngle, Kind, colour);
+
+    ROUND_SHAPE Shape;
+    SECTOR Sector;
+    INT64 Sweep = (INT64)EndAngle - StartAngle;
+
+    if (rx < 0 || ry < 0 || rx > ELLIPSE_MAX_RADIUS || ry > ELLIPSE_MAX_RADIUS) {
+        DbgPrint(DL_ERROR, "%a(), radius out of range => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    if (Sweep <= -3600 || Sweep >= 3600) {
+        if (init_round_shape(Ctx, &Shape, xc, yc, xc, yc, rx, ry, NULL)) {
+            draw_round_shape(Ctx, &Shape, (BOOLEAN)(Kind == ARC_FILL_PIE), colour);
+        }
+        return EFI_SUCCESS;
+    }
+    Sweep = ((Sweep % 3600) + 3600) % 3600;
+    if (Sweep == 0) {
+        return EFI_SUCCESS;
+    }
+    StartAngle %= 3600;
+    EndAngle %= 3600;
+    Sector.Cs = fixed_sin(StartAngle + 900);
+    Sector.Ss = fixed_sin(StartAngle);
+    Sector.Ce = fixed_sin(EndAngle + 900);
+    Sector.Se = fixed_sin(EndAngle);
+    Sector.Reflex = (BOOLEAN)(Sweep > 1800);
+
+    if (init_round_shape(Ctx, &Shape, xc, yc, xc, yc, rx, ry, &Sector)) {
+        draw_round_shape(Ctx, &Shape, (BOOLEAN)(Kind == ARC_FILL_PIE), colour);
+    }
+    if (Kind == ARC_PIE && ABS(xc) <= LINE_MAX_ORD && ABS(yc) <= LINE_MAX_ORD) {
+        // radii to where the ellipse (not the +1/2 one the pixels are inside) crosses each edge
+        INT64 x;
+        INT64 y;
+        ellipse_point(rx, ry, Sector.Cs, Sector.Ss, &x, &y);
+        clip_line(Ctx, xc, yc, (INT32)(xc + x), (INT32)(yc + y), colour);
+        ellipse_point(rx, ry, Sector.Ce, Sector.Se, &x, &y);
+        clip_line(Ctx, xc, yc, (INT32)(xc + x), (INT32)(yc + y), colour);
+    }
+    return EFI_SUCCESS;
+}
+
+/*
+ * ellipse_point() - nearest pixel to where direction (c, s) (16.16) from the centre meets the ellipse
+ */
+STATIC VOID ellipse_point(INT32 rx, INT32 ry, INT64 c, INT64 s, INT64 *x, INT64 *y)
+{
+    // the distance along (c, s) / 65536 is rx * ry * 65536 / sqrt(ry^2 c^2 + rx^2 s^2)
+    INT64 D = (INT64)isqrt64((UINT64)((INT64)ry * ry * c * c) + (UINT64)((INT64)rx * rx * s * s));
+    INT64 r;
+
+    if (D == 0) {
+        *x = 0;
+        *y = 0;
+        return;
+    }
+    *x = floor_div(2 * (INT64)rx * ry * c + D, 2 * D, &r);
+    *y = floor_div(2 * (INT64)rx * ry * s + D, 2 * D, &r);
+}
+
+/*
+ * DrawRoundedRectangle() - rectangle with corners of radius r, r is limited to half the width and height
+ */
+EFI_STATUS DrawRoundedRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 r, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(x0=%d, y0=%d, x1=%d, y1=%d, r=%d, colour=0x%08X)\n", __func__, x0, y0, x1, y1, r, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_rounded_rectangle(&gCurrCtx, x0, y0, x1, y1, r, FALSE, colour);
+}
+
+EFI_STATUS CtxDrawRoundedRectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 r, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, r=%d, colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, r, colour);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_rounded_rectangle(Ctx, x0, y0, x1, y1, r, FALSE, colour);
+}
+
+EFI_STATUS DrawFillRoundedRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 r, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(x0=%d, y0=%d, x1=%d, y1=%d, r=%d, colour=0x%08X)\n", __func__, x0, y0, x1, y1, r, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_rounded_rectangle(&gCurrCtx, x0, y0, x1, y1, r, TRUE, colour);
+}
+
+EFI_STATUS CtxDrawFillRoundedRectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 r, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, r=%d, colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, r, colour);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_rounded_rectangle(Ctx, x0, y0, x1, y1, r, TRUE, colour);
+}
+
+STATIC EFI_STATUS draw_rounded_rectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 r, BOOLEAN Fill, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, r=%d, Fill=%d, colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, r, Fill, colour);
+
+    ROUND_SHAPE Shape;
+    INT64 Left = MIN(x0, x1);
+    INT64 Right = MAX(x0, x1);
+    INT64 Top = MIN(y0, y1);
+    INT64 Bottom = MAX(y0, y1);
+
+    r = (INT32)MIN(r, MIN(Right - Left, Bottom - Top) / 2);
+    if (r < 0 || r > ELLIPSE_MAX_RADIUS) {
+        DbgPrint(DL_ERROR, "%a(), radius out of range => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    if (init_round_shape(Ctx, &Shape, Left + r, Top + r, Right - r, Bottom - r, r, r, NULL)) {
+        draw_round_shape(Ctx, &Shape, Fill, colour);
+    }
+    return EFI_SUCCESS;
+}
+
+/*
+ * FloodFill()
+ */
+
+EFI_STATUS FloodFill(INT32 x, INT32 y, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(x=%d, y=%d, colour=0x%08X)\n", __func__, x, y, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return flood_fill(&gCurrCtx, x, y, colour);
+}
+
+EFI_STATUS CtxFloodFill(GFX_CONTEXT *Ctx, INT32 x, INT32 y, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x=%d, y=%d, colour=0x%08X)\n", __func__, Ctx, x, y, colour);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return flood_fill(Ctx, x, y, colour);
+}
+
+/*
+ * flood_fill() - fill the 4-connected region of the seed pixel's colour inside the clip window
+ *
+ * Heckbert's span fill. Each stack entry is a run of row Y - Dy that is in
+ * the region, so row Y is searched from X0 to X1 for runs to fill. A run
+ * reaching past X0..X1 pushes the overhang back towards the row it came
+ * from. The stack starts at FLOOD_STACK_SPANS entries and doubles up to
+ * FLOOD_MAX_SPANS; past that the fill stops with EFI_OUT_OF_RESOURCES and
+ * the region is left part filled.
+ */
+STATIC EFI_STATUS flood_fill(GFX_CONTEXT *Ctx, INT32 x, INT32 y, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x=%d, y=%d, colour=0x%08X)\n", __func__, Ctx, x, y, colour);
+
+    if (x < Ctx->ClipX0 || x > Ctx->ClipX1 || y < Ctx->ClipY0 || y > Ctx->ClipY1) {
+        return EFI_SUCCESS;
+    }
+    INT32 PixPerScnLn = Ctx->RenBuf->PixPerScnLn;
+    UINT32 Target = *(Ctx->RenBuf->PixelData + x + (y * PixPerScnLn));
+    if (Target == colour) {
+        return EFI_SUCCESS;
+    }
+    FLOOD_STACK Stack;
+    Stack.Spans = AllocatePool(FLOOD_STACK_SPANS * sizeof(FLOOD_SPAN));
+    if (!Stack.Spans) {
+        DbgPrint(DL_ERROR, "%a(), memory allocation error => EFI_OUT_OF_RESOURCES\n", __func__);
+        return EFI_OUT_OF_RESOURCES;
+    }
+    Stack.Num = 0;
+    Stack.Max = FLOOD_STACK_SPANS;
+    // the seed row, then the row below as if the seed had come from above
+    flood_push(Ctx, &Stack, y, x, x, -1);
+    EFI_STATUS Status = flood_push(Ctx, &Stack, y + 1, x, x, 1);
+
+    EDK2SIM_GFX_BEGIN;
+    while (Stack.Num && !EFI_ERROR(Status)) {
+        FLOOD_SPAN Span = Stack.Spans[--Stack.Num];
+        UINT32 *Row = Ctx->RenBuf->PixelData + (Span.Y * PixPerScnLn);
+        INT32 l = Span.X0;
+        INT32 r;
+        if (Row[l] == Target) {
+            l = flood_run(Row, l, Ctx->ClipX0, -1, Target);
+            if (l < Span.X0) {
+                Status = flood_push(Ctx, &Stack, Span.Y - Span.Dy, l, Span.X0 - 1, -Span.Dy);
+            }
+        } else {
+            while (l <= Span.X1 && Row[l] != Target) {
+                l++;
+            }
+        }
+        while (l <= Span.X1 && !EFI_ERROR(Status)) {
+            r = flood_run(Row, l, Ctx->ClipX1, 1, Target);
+            fill_shape_row(Row, l, r, colour);
+            Status = flood_push(Ctx, &Stack, Span.Y + Span.Dy, l, r, Span.Dy);
+            if (r > Span.X1 && !EFI_ERROR(Status)) {
+                Status = flood_push(Ctx, &Stack, Span.Y - Span.Dy, Span.X1 + 1, r, -Span.Dy);
+            }
+            // Row[r + 1] is not Target or is outside the clip window
+            for (l = r + 2; l <= Span.X1 && Row[l] != Target; l++) {
+            }
+        }
+    }
+    EDK2SIM_GFX_END;
+    FreePool(Stack.Spans);
+    return Status;
+}
+
+/*
+ * flood_run() - last x reached from x stepping by Step towards Limit with every pixel Target
+ *
+ * Four pixels are compared per step for the long runs of a large region.
+ */
+STATIC INT32 flood_run(CONST UINT32 *Row, INT32 x, INT32 Limit, INT32 Step, UINT32 Target)
+{
+    while ((Limit - x) * Step >= 4 &&
+           ((Row[x + Step] ^ Target) | (Row[x + 2 * Step] ^ Target) | (Row[x + 3 * Step] ^ Target) | (Row[x + 4 * Step] ^ Target)) == 0) {
+        x += 4 * Step;
+    }
+    while (x != Limit && Row[x + Step] == Target) {
+        x += Step;
+    }
+    return x;
+}
+
+/*
+ * flood_push() - push span X0..X1 of row y, coming from row y - dy, rows outside the clip window are dropped
+ */
+STATIC EFI_STATUS flood_push(GFX_CONTEXT *Ctx, FLOOD_STACK *Stack, INT32 y, INT32 x0, INT32 x1, INT32 dy)
+{
+    if (y < Ctx->ClipY0 || y > Ctx->ClipY1) {
+        return EFI_SUCCESS;
+    }
+    if (Stack->Num == Stack->Max) {
+        if (Stack->Max >= FLOOD_MAX_SPANS) {
+            DbgPrint(DL_ERROR, "%a(), span stack full => EFI_OUT_OF_RESOURCES\n", __func__);
+            return EFI_OUT_OF_RESOURCES;
+        }
+        UINTN Max = Stack->Max * 2;
+        FLOOD_SPAN *Spans = ReallocatePool(Stack->Max * sizeof(FLOOD_SPAN), Max * sizeof(FLOOD_SPAN), Stack->Spans);
+        if (!Spans) {
+            DbgPrint(DL_ERROR, "%a(), memory allocation error => EFI_OUT_OF_RESOURCES\n", __func__);
+            return EFI_OUT_OF_RESOURCES;
+        }
+        Stack->Spans = Spans;
+        Stack->Max = Max;
+    }
+    FLOOD_SPAN *Span = &Stack->Spans[Stack->Num++];
+    Span->Y = y;
+    Span->X0 = x0;
+    Span->X1 = x1;
+    Span->Dy = dy;
+    return EFI_SUCCESS;
+}
+
+/*
+ * DrawGradientRectangle()
+ */
+
+EFI_STATUS DrawGradientRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, CONST GRADIENT *Gradient)
+{
+    DbgPrint(DL_INFO, "%a(x0=%d, y0=%d, x1=%d, y1=%d, Gradient=0x%p)\n", __func__, x0, y0, x1, y1, Gradient);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_gradient_rectangle(&gCurrCtx, x0, y0, x1, y1, Gradient);
+}
+
+EFI_STATUS CtxDrawGradientRectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, CONST GRADIENT *Gradient)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, Gradient=0x%p)\n", __func__, Ctx, x0, y0, x1, y1, Gradient);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_gradient_rectangle(Ctx, x0, y0, x1, y1, Gradient);
+}
+
+EFI_STATUS DrawGradientSpan(INT32 x0, INT32 x1, INT32 y, CONST GRADIENT *Gradient)
+{
+    DbgPrint(DL_INFO, "%a(x0=%d, x1=%d, y=%d, Gradient=0x%p)\n", __func__, x0, x1, y, Gradient);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_gradient_rectangle(&gCurrCtx, x0, y, x1, y, Gradient);
+}
+
+EFI_STATUS CtxDrawGradientSpan(GFX_CONTEXT *Ctx, INT32 x0, INT32 x1, INT32 y, CONST GRADIENT *Gradient)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, x1=%d, y=%d, Gradient=0x%p)\n", __func__, Ctx, x0, x1, y, Gradient);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_gradient_rectangle(Ctx, x0, y, x1, y, Gradient);
+}
+
+/*
+ * draw_gradient_rectangle() - fill rectangle with gradient a row at a time
+ *
+ * A linear gradient with no vertical change has the same rows all the way
+ * down, or the same four with dithering, so later rows are copied.
+ */
+STATIC EFI_STATUS draw_gradient_rectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, CONST GRADIENT *Gradient)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, Gradient=0x%p)\n", __func__, Ctx, x0, y0, x1, y1, Gradient);
+
+    GRADIENT_PAINT Paint;
+    EFI_STATUS Status = init_gradient(&Paint, Gradient);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    INT32 xl = MAX(MIN(x0, x1), Ctx->ClipX0);
+    INT32 xr = MIN(MAX(x0, x1), Ctx->ClipX1);
+    INT32 yt = MAX(MIN(y0, y1), Ctx->ClipY0);
+    INT32 yb = MIN(MAX(y0, y1), Ctx->ClipY1);
+    if (xl > xr || yt > yb) {
+        return EFI_SUCCESS;
+    }
+    INT32 PixPerScnLn = Ctx->RenBuf->PixPerScnLn;
+    UINT32 *ptr = Ctx->RenBuf->PixelData + xl + (yt * PixPerScnLn);
+    INT32 Period = (Gradient->Type == GRADIENT_LINEAR && Paint.Dy == 0) ? (Gradient->Dither ? 4 : 1) : MAX_INT32;
+
+    EDK2SIM_GFX_BEGIN;
+    for (INT32 y = yt; y <= yb; y++) {
+        if (y - yt >= Period) {
+            CopyMem(ptr, ptr - (Period * PixPerScnLn), (UINTN)(xr - xl + 1) * sizeof(UINT32));
+        } else {
+            gradient_row(&Paint, xl, xr, y, ptr);
+        }
+        ptr += PixPerScnLn;
+    }
+    EDK2SIM_GFX_END;
+    return EFI_SUCCESS;
+}
+
+// 4x4 Bayer matrix, thresholds in sixteenths of a colour step
+STATIC CONST UINT8 gBayer4[4][4] = {
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 }
+};
+
+// sqrt((j + 1/2) / RADIAL_LUT_SIZE) as a gradient index with 8 fraction bits, built on first use
+STATIC UINT16 gRadialLut[RADIAL_LUT_SIZE];
+STATIC BOOLEAN gRadialLutReady = FALSE;
+
+/*
+ * init_gradient() - check Gradient and set up its colour table and steps
+ */
+STATIC EFI_STATUS init_gradient(GRADIENT_PAINT *Paint, CONST GRADIENT *Gradient)
+{
+    if (!Gradient || Gradient->Type >= NUM_GRADIENT_TYPES || Gradient->Radius > GRADIENT_MAX_ORD ||
+        ABS(Gradient->X0) > GRADIENT_MAX_ORD || ABS(Gradient->Y0) > GRADIENT_MAX_ORD ||
+        ABS(Gradient->X1) > GRADIENT_MAX_ORD || ABS(Gradient->Y1) > GRADIENT_MAX_ORD) {
+        DbgPrint(DL_ERROR, "%a(), invalid gradient => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    Paint->Gradient = Gradient;
+    // each channel rounded from C0 to C1, lerp_colour() would truncate
+    for (UINT32 k = 0; k < GRADIENT_STEPS; k++) {
+        UINT32 c = 0;
+        for (UINT32 s = 0; s < 32; s += 8) {
+            UINT32 a = (Gradient->C0 >> s) & 0xFF;
+            UINT32 b = (Gradient->C1 >> s) & 0xFF;
+            c |= (((a * (GRADIENT_STEPS - 1 - k)) + (b * k) + ((GRADIENT_STEPS - 1) / 2)) / (GRADIENT_STEPS - 1)) << s;
+        }
+        Paint->Colours[k] = c;
+    }
+    if (Gradient->Type == GRADIENT_LINEAR) {
+        // index is the projection onto (Dx, Dy) over its squared length, all C1 when the end points meet
+        Paint->Dx = (INT64)Gradient->X1 - Gradient->X0;
+        Paint->Dy = (INT64)Gradient->Y1 - Gradient->Y0;
+        Paint->L2 = (Paint->Dx * Paint->Dx) + (Paint->Dy * Paint->Dy);
+        Paint->Step = 0;
+        Paint->StepRem = 0;
+        if (Paint->L2) {
+            Paint->Step = floor_div(Paint->Dx * GRADIENT_TOP, Paint->L2, &Paint->StepRem);
+        }
+        return EFI_SUCCESS;
+    }
+    if (!gRadialLutReady) {
+        for (UINT64 j = 0; j < RADIAL_LUT_SIZE; j++) {
+            gRadialLut[j] = (UINT16)isqrt64(DivU64x32((2 * j + 1) * (GRADIENT_TOP >> 8) * (GRADIENT_TOP >> 8), 2 * RADIAL_LUT_SIZE));
+        }
+        gRadialLutReady = TRUE;
+    }
+    Paint->R2 = (UINT64)Gradient->Radius * Gradient->Radius;
+    Paint->InvR2 = Paint->R2 ? DivU64x64Remainder((UINT64)RADIAL_LUT_SIZE << 32, Paint->R2, NULL) : 0;
+    return EFI_SUCCESS;
+}
+
+/*
+ * gradient_row() - colours of pixels x0..x1 of row y into Dst
+ *
+ * A linear gradient's index is floor(projection * GRADIENT_TOP / L2),
+ * stepped along the row as quotient and remainder so every pixel is exact
+ * and clipping does not move the colour bands. A radial gradient steps the squared distance and
+ * looks its index up in gRadialLut, so there is no square root per pixel.
+ * Dithering adds the row's Bayer thresholds before the index is truncated,
+ * otherwise it is rounded.
+ */
+STATIC VOID gradient_row(CONST GRADIENT_PAINT *Paint, INT32 x0, INT32 x1, INT32 y, UINT32 *Dst)
+{
+    CONST GRADIENT *Gradient = Paint->Gradient;
+    INT64 Dither[4];
+
+    for (UINTN i = 0; i < 4; i++) {
+        Dither[i] = Gradient->Dither ? ((INT64)gBayer4[y & 3][i] << 12) + 0x800 : 0x8000;
+    }
+    if (Gradient->Type == GRADIENT_LINEAR) {
+        if (Paint->L2 == 0) {
+            fill_shape_row(Dst, 0, x1 - x0, Paint->Colours[GRADIENT_STEPS - 1]);
+            return;
+        }
+        INT64 Rem;
+        INT64 Num = ((INT64)(x0 - Gradient->X0) * Paint->Dx) + ((INT64)(y - Gradient->Y0) * Paint->Dy);
+        INT64 t = floor_div(Num * GRADIENT_TOP, Paint->L2, &Rem);
+        if (Paint->Dx == 0) {
+            // one colour along the row, or the four of the row's dither pattern repeated
+            UINT32 Pattern[4];
+            for (UINTN k = 0; k < 4; k++) {
+                INT64 i = ARShiftU64(t + Dither[(x0 + k) & 3], 16);
+                Pattern[k] = Paint->Colours[(i < 0) ? 0 : MIN(i, GRADIENT_STEPS - 1)];
+            }
+            if (!Gradient->Dither) {
+                fill_shape_row(Dst, 0, x1 - x0, Pattern[0]);
+                return;
+            }
+            INT32 n = x1 - x0 + 1;
+            INT32 k = 0;
+            for (; k + 4 <= n; k += 4) {
+                Dst[k] = Pattern[0];
+                Dst[k + 1] = Pattern[1];
+                Dst[k + 2] = Pattern[2];
+                Dst[k + 3] = Pattern[3];
+            }
+            for (; k < n; k++) {
+                Dst[k] = Pattern[k & 3];
+            }
+            return;
+        }
+        for (INT32 x = x0; x <= x1; x++) {
+            INT64 i = ARShiftU64(t + Dither[x & 3], 16);
+            *Dst++ = Paint->Colours[(i < 0) ? 0 : MIN(i, GRADIENT_STEPS - 1)];
+            t += Paint->Step;
+            Rem += Paint->StepRem;
+            if (Rem >= Paint->L2) {
+                Rem -= Paint->L2;
+                t++;
+            }
+        }
+        return;
+    }
+    INT64 u = (INT64)x0 - Gradient->X0;
+    INT64 v = (INT64)y - Gradient->Y0;
+    UINT64 d2 = (UINT64)((u * u) + (v * v));
+    UINT32 Outer = Paint->Colours[GRADIENT_STEPS - 1];
+    for (INT32 x = x0; x <= x1; x++) {
+        if (d2 >= Paint->R2) {
+            *Dst++ = Outer;
+        } else {
+            INT64 i = ((INT64)gRadialLut[RShiftU64(d2 * Paint->InvR2, 32)] << 8) + Dither[x & 3];
+            *Dst++ = Paint->Colours[MIN(i >> 16, GRADIENT_STEPS - 1)];
+        }
+        d2 += (2 * u) + 1;
+        u++;
+    }
+}
+
+/*
+ * DrawBrushRectangle()
+ */
+
+EFI_STATUS DrawBrushRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, CONST BRUSH *Brush)
+{
+    DbgPrint(DL_INFO, "%a(x0=%d, y0=%d, x1=%d, y1=%d, Brush=0x%p)\n", __func__, x0, y0, x1, y1, Brush);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_brush_rectangle(&gCurrCtx, x0, y0, x1, y1, Brush);
+}
+
+EFI_STATUS CtxDrawBrushRectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, CONST BRUSH *Brush)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, Brush=0x%p)\n", __func__, Ctx, x0, y0, x1, y1, Brush);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_brush_rectangle(Ctx, x0, y0, x1, y1, Brush);
+}
+
+EFI_STATUS DrawBrushPolygon(CONST POINT *Points, UINTN Count, FILL_RULE Rule, CONST BRUSH *Brush)
+{
+    DbgPrint(DL_INFO, "%a(Points=0x%p, Count=%u, Rule=%u, Brush=0x%p)\n", __func__, Points, Count, Rule, Brush);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    if (!check_brush(Brush)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_fill_polygon(&gCurrCtx, Points, &Count, 1, 0, Rule, 0, Brush);
+}
+
+EFI_STATUS CtxDrawBrushPolygon(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, FILL_RULE Rule, CONST BRUSH *Brush)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Points=0x%p, Count=%u, Rule=%u, Brush=0x%p)\n", __func__, Ctx, Points, Count, Rule, Brush);
+
+    if (!check_context(Ctx) || !check_brush(Brush)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_fill_polygon(Ctx, Points, &Count, 1, 0, Rule, 0, Brush);
+}
+
+EFI_STATUS DrawBrushCircle(INT32 xc, INT32 yc, INT32 r, CONST BRUSH *Brush)
+{
+    DbgPrint(DL_INFO, "%a(xc=%d, yc=%d, r=%d, Brush=0x%p)\n", __func__, xc, yc, r, Brush);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    if (!check_brush(Brush) || r < 0) {
+        return EFI_INVALID_PARAMETER;
+    }
+    draw_fill_circle(&gCurrCtx, xc, yc, r, 0, Brush);
+    return EFI_SUCCESS;
+}
+
+EFI_STATUS CtxDrawBrushCircle(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 r, CONST BRUSH *Brush)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, xc=%d, yc=%d, r=%d, Brush=0x%p)\n", __func__, Ctx, xc, yc, r, Brush);
+
+    if (!check_context(Ctx) || !check_brush(Brush) || r < 0) {
+        return EFI_INVALID_PARAMETER;
+    }
+    draw_fill_circle(Ctx, xc, yc, r, 0, Brush);
+    return EFI_SUCCESS;
+}
+
+/*
+ * draw_brush_rectangle() - fill rectangle with Brush a row at a time
+ */
+STATIC EFI_STATUS draw_brush_rectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, CONST BRUSH *Brush)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, Brush=0x%p)\n", __func__, Ctx, x0, y0, x1, y1, Brush);
+
+    if (!check_brush(Brush)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    INT32 xl = MAX(MIN(x0, x1), Ctx->ClipX0);
+    INT32 xr = MIN(MAX(x0, x1), Ctx->ClipX1);
+    INT32 yt = MAX(MIN(y0, y1), Ctx->ClipY0);
+    INT32 yb = MIN(MAX(y0, y1), Ctx->ClipY1);
+    if (xl > xr || yt > yb) {
+        return EFI_SUCCESS;
+    }
+    UINT32 *Row = Ctx->RenBuf->PixelData + (yt * Ctx->RenBuf->PixPerScnLn);
+
+    EDK2SIM_GFX_BEGIN;
+    for (INT32 y = yt; y <= yb; y++) {
+        brush_span(Brush, Row, xl, xr, y);
+        Row += Ctx->RenBuf->PixPerScnLn;
+    }
+    EDK2SIM_GFX_END;
+    return EFI_SUCCESS;
+}
+
+/*
+ * check_brush() - TRUE if Brush is usable
+ */
+STATIC BOOLEAN check_brush(CONST BRUSH *Brush)
+{
+    if (!Brush || Brush->Type >= NUM_BRUSH_TYPES || (Brush->Type == BRUSH_TILE && !check_texture(Brush->Tile))) {
+        DbgPrint(DL_ERROR, "%a(), invalid brush\n", __func__);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * brush_span() - set Row[xl..xr] of row y from Brush
+ *
+ * The first period of the span (8 pixels of pattern, or a tile row) is
+ * written already rotated to start at xl, then copied onto the rest of the
+ * span in doubling blocks, so a span costs a few CopyMem() calls much like
+ * a solid fill. A transparent pattern only writes the set bits of its
+ * rotated row.
+ */
+STATIC VOID brush_span(CONST BRUSH *Brush, UINT32 *Row, INT64 xl, INT64 xr, INT64 y)
+{
+    UINT32 *Dst = Row + xl;
+    UINTN Width = (UINTN)(xr - xl + 1);
+    UINTN Period;
+
+    if (Brush->Type == BRUSH_PATTERN) {
+        UINT32 s = (UINT32)(xl - Brush->OriginX) & 7;
+        UINT32 Bits = Brush->Pattern[(y - Brush->OriginY) & 7];
+        // bit 7 is pixel xl
+        Bits = ((Bits << s) | (Bits >> (8 - s))) & 0xFF;
+        if (Brush->Transparent) {
+            for (UINTN k = 0; k < Width; k++) {
+                if (Bits & (0x80 >> (k & 7))) {
+                    Dst[k] = Brush->FgColour;
+                }
+            }
+            return;
+        }
+        Period = MIN(Width, 8);
+        for (UINTN k = 0; k < Period; k++) {
+            Dst[k] = (Bits & (0x80 >> k)) ? Brush->FgColour : Brush->BgColour;
+        }
+    } else {
+        CONST RENDER_BUFFER *Tile = Brush->Tile;
+        INT64 tx;
+        INT64 ty;
+        floor_div(xl - Brush->OriginX, Tile->HorRes, &tx);
+        floor_div(y - Brush->OriginY, Tile->VerRes, &ty);
+        CONST UINT32 *Src = Tile->PixelData + (ty * Tile->PixPerScnLn);
+        Period = MIN(Width, (UINTN)Tile->HorRes);
+        UINTN n = MIN(Period, (UINTN)(Tile->HorRes - tx));
+        CopyMem(Dst, Src + tx, n * sizeof(UINT32));
+        if (n < Period) {
+            CopyMem(Dst + n, Src, (Period - n) * sizeof(UINT32));
+        }
+    }
+    for (UINTN Done = Period; Done < Width; Done += MIN(Done, Width - Done)) {
+        CopyMem(Dst + Done, Dst, MIN(Done, Width - Done) * sizeof(UINT32));
+    }
+}
+
+UINTN DrawPoints(CONST POINT *Points, UINTN Count, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Points=0x%p, Count=%u, colour=0x%08X)\n", __func__, Points, Count, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => 0\n", __func__);
+        return 0;
+    }
+    return draw_points(&gCurrCtx, Points, NULL, Count, colour);
+}
+
+UINTN CtxDrawPoints(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Points=0x%p, Count=%u, colour=0x%08X)\n", __func__, Ctx, Points, Count, colour);
+
+    if (!check_context(Ctx)) {
+        return 0;
+    }
+    return draw_points(Ctx, Points, NULL, Count, colour);
+}
+
+UINTN DrawColourPoints(CONST POINT *Points, CONST UINT32 *Colours, UINTN Count)
+{
+    DbgPrint(DL_INFO, "%a(Points=0x%p, Colours=0x%p, Count=%u)\n", __func__, Points, Colours, Count);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => 0\n", __func__);
+        return 0;
+    }
+    if (!Colours) {
+        DbgPrint(DL_ERROR, "%a(), Colours=NULL => 0\n", __func__);
+        return 0;
+    }
+    return draw_points(&gCurrCtx, Points, Colours, Count, 0);
+}
+
+UINTN CtxDrawColourPoints(GFX_CONTEXT *Ctx, CONST POINT *Points, CONST UINT32 *Colours, UINTN Count)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Points=0x%p, Colours=0x%p, Count=%u)\n", __func__, Ctx, Points, Colours, Count);
+
+    if (!check_context(Ctx)) {
+        return 0;
+    }
+    if (!Colours) {
+        DbgPrint(DL_ERROR, "%a(), Colours=NULL => 0\n", __func__);
+        return 0;
+    }
+    return draw_points(Ctx, Points, Colours, Count, 0);
+}
+
+// Large point sets drawn to the screen are bucketed by band of scanlines first, as
+// frame buffer memory is normally uncached so scattered writes are expensive
+#define SORT_POINTS_MIN     16384
+#define POINT_BAND_SHIFT    4   // 16 scanlines per band
+
+/*
+ * draw_points() - return number of points inside clip window (Colours=NULL for single colour)
+ */
+STATIC UINTN draw_points(GFX_CONTEXT *Ctx, CONST POINT *Points, CONST UINT32 *Colours, UINTN Count, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Points=0x%p, Colours=0x%p, Count=%u, colour=0x%08X)\n", __func__, Ctx, Points, Colours, Count, colour);
+
+    if (!Points || !Count) {
+        return 0;
+    }
+    // render buffers are cached pool memory, where scattered writes cost less than the sort
+    if (Count >= SORT_POINTS_MIN && Ctx->RenderToScreen) {
+        UINTN Drawn = draw_sorted_points(Ctx, Points, Colours, Count, colour);
+        if (Drawn != MAX_UINTN) {
+            return Drawn;
+        }
+    }
+    UINT32 *base = Ctx->RenBuf->PixelData;
+    INT32 PixPerScnLn = Ctx->RenBuf->PixPerScnLn;
+    INT32 ClipX0 = Ctx->ClipX0;
+    INT32 ClipY0 = Ctx->ClipY0;
+    // unsigned compare clips each axis against both edges at once
+    UINT32 ClipW = Ctx->ClipX1 - ClipX0;
+    UINT32 ClipH = Ctx->ClipY1 - ClipY0;
+    UINTN Drawn = 0;
+
+    EDK2SIM_GFX_BEGIN;
+    if (Colours) {
+        for (UINTN i = 0; i < Count; i++) {
+            INT32 x = Points[i].X;
+            INT32 y = Points[i].Y;
+            if ((UINT32)(x - ClipX0) <= ClipW && (UINT32)(y - ClipY0) <= ClipH) {
+                base[x + (y * PixPerScnLn)] = Colours[i];
+                Drawn++;
+            }
+        }
+    } else {
+        for (UINTN i = 0; i < Count; i++) {
+            INT32 x = Points[i].X;
+            INT32 y = Points[i].Y;
+            if ((UINT32)(x - ClipX0) <= ClipW && (UINT32)(y - ClipY0) <= ClipH) {
+                base[x + (y * PixPerScnLn)] = colour;
+                Drawn++;
+            }
+        }
+    }
+    EDK2SIM_GFX_END;
+
+    return Drawn;
+}
+
+/*
+ * draw_sorted_points() - bucket points by scanline band (stable counting sort)
+ * then draw, returns MAX_UINTN if working memory not available
+ */
+STATIC UINTN draw_sorted_points(GFX_CONTEXT *Ctx, CONST POINT *Points, CONST UINT32 *Colours, UINTN Count, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Points=0x%p, Colours=0x%p, Count=%u, colour=0x%08X)\n", __func__, Ctx, Points, Colours, Count, colour);
+
+    if (Count > MAX_UINT32) {
+        return MAX_UINTN;
+    }
+    INT32 ClipX0 = Ctx->ClipX0;
+    INT32 ClipY0 = Ctx->ClipY0;
+    UINT32 ClipW = Ctx->ClipX1 - ClipX0;
+    UINT32 ClipH = Ctx->ClipY1 - ClipY0;
+    UINTN NumBands = (ClipH >> POINT_BAND_SHIFT) + 1;
+    UINT32 *Band = AllocateZeroPool((NumBands + 1) * sizeof(UINT32));
+    UINT32 *Order = AllocatePool(Count * sizeof(UINT32));
+    if (!Band || !Order) {
+        DbgPrint(DL_WARN, "%a(), memory allocation error => MAX_UINTN\n", __func__);
+        if (Band) {
+            FreePool(Band);
+        }
+        if (Order) {
+            FreePool(Order);
+        }
+        return MAX_UINTN;
+    }
+    // count visible points in each band
+    for (UINTN i = 0; i < Count; i++) {
+        UINT32 dx = Points[i].X - ClipX0;
+        UINT32 dy = Points[i].Y - ClipY0;
+        if (dx <= ClipW && dy <= ClipH) {
+            Band[(dy >> POINT_BAND_SHIFT) + 1]++;
+        }
+    }
+    for (UINTN b = 1; b <= NumBands; b++) {
+        Band[b] += Band[b - 1];
+    }
+    UINTN Drawn = Band[NumBands];
+    // order point indices by band
+    for (UINTN i = 0; i < Count; i++) {
+        UINT32 dx = Points[i].X - ClipX0;
+        UINT32 dy = Points[i].Y - ClipY0;
+        if (dx <= ClipW && dy <= ClipH) {
+            Order[Band[dy >> POINT_BAND_SHIFT]++] = (UINT32)i;
+        }
+    }
+    UINT32 *base = Ctx->RenBuf->PixelData;
+    INT32 PixPerScnLn = Ctx->RenBuf->PixPerScnLn;
+
+    EDK2SIM_GFX_BEGIN;
+    for (UINTN n = 0; n < Drawn; n++) {
+        UINT32 i = Order[n];
+        base[Points[i].X + (Points[i].Y * PixPerScnLn)] = Colours ? Colours[i] : colour;
+    }
+    EDK2SIM_GFX_END;
+
+    FreePool(Band);
+    FreePool(Order);
+
+    return Drawn;
+}
+
+VOID DrawPlot(CONST INT32 *Samples, UINTN Count, INT32 MinVal, INT32 MaxVal, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Samples=0x%p, Count=%u, MinVal=%d, MaxVal=%d, x0=%d, y0=%d, x1=%d, y1=%d, colour=0x%08X)\n", __func__, Samples, Count, MinVal, MaxVal, x0, y0, x1, y1, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised\n", __func__);
+        return;
+    }
+    draw_plot(&gCurrCtx, Samples, Count, MinVal, MaxVal, x0, y0, x1, y1, colour);
+}
+
+VOID CtxDrawPlot(GFX_CONTEXT *Ctx, CONST INT32 *Samples, UINTN Count, INT32 MinVal, INT32 MaxVal, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Samples=0x%p, Count=%u, MinVal=%d, MaxVal=%d, x0=%d, y0=%d, x1=%d, y1=%d, colour=0x%08X)\n", __func__, Ctx, Samples, Count, MinVal, MaxVal, x0, y0, x1, y1, colour);
+
+    if (!check_context(Ctx)) {
+        return;
+    }
+    draw_plot(Ctx, Samples, Count, MinVal, MaxVal, x0, y0, x1, y1, colour);
+}
+
+/*
+ * plot_y() - map sample value to y-ord, scale is 16.16 pixels per unit
+ */
+STATIC INT32 plot_y(INT32 v, INT32 MinVal, INT32 MaxVal, INT32 yb, INT64 scale)
+{
+    if (v < MinVal) {
+        v = MinVal;
+    } else if (v > MaxVal) {
+        v = MaxVal;
+    }
+    return yb - (INT32)RShiftU64((UINT64)(((INT64)v - MinVal) * scale), 16);
+}
+
+/*
+ * plot_sample() - sample value at 32.32 fixed point position (linear interpolation)
+ */
+STATIC INT32 plot_sample(CONST INT32 *Samples, UINTN Count, UINT64 pos)
+{
+    UINTN i = (UINTN)RShiftU64(pos, 32);
+    UINT32 frac = (UINT32)pos >> 16;
+    if (frac == 0 || i + 1 >= Count) {
+        return Samples[i];
+    }
+    return Samples[i] + (INT32)ARShiftU64(((INT64)Samples[i + 1] - Samples[i]) * frac, 16);
+}
+
+/*
+ * draw_plot() - draw samples across rectangle as one vertical span per pixel column
+ *
+ * Sample i sits at x = i * (width - 1) / (Count - 1) and each column spans the
+ * min/max of the trace between its left and right edge, so the cost is
+ * O(Count + width) whether zoomed in or out.
+ */
+STATIC VOID draw_plot(GFX_CONTEXT *Ctx, CONST INT32 *Samples, UINTN Count, INT32 MinVal, INT32 MaxVal, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Samples=0x%p, Count=%u, MinVal=%d, MaxVal=%d, x0=%d, y0=%d, x1=%d, y1=%d, colour=0x%08X)\n", __func__, Ctx, Samples, Count, MinVal, MaxVal, x0, y0, x1, y1, colour);
+
+    if (!Samples || Count == 0 || MaxVal <= MinVal) {
+        DbgPrint(DL_WARN, "%a(), nothing to plot\n", __func__);
+        return;
+    }
+    // determine top-left and bottom-right
+    if (x1 < x0) {
+        SWAP(INT32, x0, x1);
+    }
+    if (y1 < y0) {
+        SWAP(INT32, y0, y1);
+    }
+    // only visit columns inside clip window
+    INT32 xl = (x0 < Ctx->ClipX0) ? Ctx->ClipX0 : x0;
+    INT32 xr = (x1 > Ctx->ClipX1) ? Ctx->ClipX1 : x1;
+    if (xl > xr || y1 < Ctx->ClipY0 || y0 > Ctx->ClipY1) {
+        return;
+    }
+    INT64 scale = DivS64x64Remainder(LShiftU64(y1 - y0, 16), (INT64)MaxVal - MinVal, NULL);
+    UINT64 end = LShiftU64(Count - 1, 32);
+    UINT64 step = (x1 > x0) ? DivU64x32(end, x1 - x0) : 0;
+    UINT64 pos = MultU64x32(step, xl - x0);
+    INT32 v = plot_sample(Samples, Count, pos);
+
+    EDK2SIM_GFX_BEGIN;
+    for (INT32 x = xl; x <= xr; x++) {
+        INT32 lo = v;
+        INT32 hi = v;
+        UINT64 next = pos + step;
+        if (next > end || x == x1) {
+            next = end;
+        }
+        // whole samples between this column and the next
+        UINTN last = (UINTN)RShiftU64(next, 32);
+        for (UINTN i = (UINTN)RShiftU64(pos, 32) + 1; i <= last; i++) {
+            if (Samples[i] < lo) {
+                lo = Samples[i];
+            } else if (Samples[i] > hi) {
+                hi = Samples[i];
+            }
+        }
+        v = plot_sample(Samples, Count, next);
+        if (v < lo) {
+            lo = v;
+        } else if (v > hi) {
+            hi = v;
+        }
+        INT32 yt = plot_y(hi, MinVal, MaxVal, y1, scale);
+        INT32 yb = plot_y(lo, MinVal, MaxVal, y1, scale);
+        draw_vline(Ctx, x, yt, yb - yt + 1, colour);
+        pos = next;
+    }
+    EDK2SIM_GFX_END;
+}
+
+EFI_STATUS InitStripChart(STRIP_CHART *Chart, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 MinVal, INT32 MaxVal, UINT32 SamplesPerColumn, UINT32 FgColour, UINT32 BgColour)
+{
+    DbgPrint(DL_INFO, "%a(Chart=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, MinVal=%d, MaxVal=%d, SamplesPerColumn=%u, FgColour=0x%08X, BgColour=0x%08X)\n", __func__, Chart, x0, y0, x1, y1, MinVal, MaxVal, SamplesPerColumn, FgColour, BgColour);
+
+    if (!Chart) {
+        DbgPrint(DL_ERROR, "%a(), Chart=NULL => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    if (MaxVal <= MinVal || SamplesPerColumn == 0) {
+        DbgPrint(DL_ERROR, "%a(), invalid range => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    // determine top-left and bottom-right
+    Chart->X0 = (x0 < x1) ? x0 : x1;
+    Chart->X1 = (x0 < x1) ? x1 : x0;
+    Chart->Y0 = (y0 < y1) ? y0 : y1;
+    Chart->Y1 = (y0 < y1) ? y1 : y0;
+    Chart->MinVal = MinVal;
+    Chart->MaxVal = MaxVal;
+    Chart->SamplesPerColumn = SamplesPerColumn;
+    // scroll in steps so the copy is amortised over several columns
+    Chart->ScrollStep = (Chart->X1 - Chart->X0 + 1) / 8;
+    if (Chart->ScrollStep < 1) {
+        Chart->ScrollStep = 1;
+    }
+    Chart->FgColour = FgColour;
+    Chart->BgColour = BgColour;
+    Chart->CurrX = Chart->X0;
+    Chart->ColSamples = 0;
+    Chart->HaveLastVal = FALSE;
+
+    return EFI_SUCCESS;
+}
+
+UINTN AppendStripChart(STRIP_CHART *Chart, CONST INT32 *Samples, UINTN Count)
+{
+    DbgPrint(DL_INFO, "%a(Chart=0x%p, Samples=0x%p, Count=%u)\n", __func__, Chart, Samples, Count);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => 0\n", __func__);
+        return 0;
+    }
+    return append_strip_chart(&gCurrCtx, Chart, Samples, Count);
+}
+
+UINTN CtxAppendStripChart(GFX_CONTEXT *Ctx, STRIP_CHART *Chart, CONST INT32 *Samples, UINTN Count)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Chart=0x%p, Samples=0x%p, Count=%u)\n", __func__, Ctx, Chart, Samples, Count);
+
+    if (!check_context(Ctx)) {
+        return 0;
+    }
+    return append_strip_chart(Ctx, Chart, Samples, Count);
+}
+
+/*
+ * append_strip_chart() - returns number of columns drawn
+ */
+STATIC UINTN append_strip_chart(GFX_CONTEXT *Ctx, STRIP_CHART *Chart, CONST INT32 *Samples, UINTN Count)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Chart=0x%p, Samples=0x%p, Count=%u)\n", __func__, Ctx, Chart, Samples, Count);
+
+    if (!Chart || !Samples) {
+        DbgPrint(DL_ERROR, "%a(), invalid parameter => 0\n", __func__);
+        return 0;
+    }
+    INT64 scale = DivS64x64Remainder(LShiftU64(Chart->Y1 - Chart->Y0, 16), (INT64)Chart->MaxVal - Chart->MinVal, NULL);
+    UINTN Columns = 0;
+
+    EDK2SIM_GFX_BEGIN;
+    for (UINTN i = 0; i < Count; i++) {
+        INT32 v = Samples[i];
+        if (Chart->ColSamples++ == 0) {
+            Chart->ColMin = v;
+            Chart->ColMax = v;
+        } else if (v < Chart->ColMin) {
+            Chart->ColMin = v;
+        } else if (v > Chart->ColMax) {
+            Chart->ColMax = v;
+        }
+        if (Chart->ColSamples < Chart->SamplesPerColumn) {
+            continue;
+        }
+        // column complete
+        if (Chart->CurrX > Chart->X1) {
+            scroll_left(Ctx, Chart->X0, Chart->Y0, Chart->X1, Chart->Y1, Chart->ScrollStep, Chart->BgColour);
+            Chart->CurrX -= Chart->ScrollStep;
+        }
+        INT32 lo = Chart->ColMin;
+        INT32 hi = Chart->ColMax;
+        if (Chart->HaveLastVal) {
+            if (Chart->LastVal < lo) {
+                lo = Chart->LastVal;
+            } else if (Chart->LastVal > hi) {
+                hi = Chart->LastVal;
+            }
+        }
+        INT32 yt = plot_y(hi, Chart->MinVal, Chart->MaxVal, Chart->Y1, scale);
+        INT32 yb = plot_y(lo, Chart->MinVal, Chart->MaxVal, Chart->Y1, scale);
+        draw_vline(Ctx, Chart->CurrX, yt, yb - yt + 1, Chart->FgColour);
+        Chart->LastVal = v;
+        Chart->HaveLastVal = TRUE;
+        Chart->ColSamples = 0;
+        Chart->CurrX++;
+        Columns++;
+    }
+    EDK2SIM_GFX_END;
+
+    return Columns;
+}
+
+/*
+ * scroll_left() - scroll rectangle (within clip window) left n pixels and fill the gap
+ */
+STATIC VOID scroll_left(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 n, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, n=%d, colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, n, colour);
+
+    if (x0 < Ctx->ClipX0) x0 = Ctx->ClipX0;
+    if (x1 > Ctx->ClipX1) x1 = Ctx->ClipX1;
+    if (y0 < Ctx->ClipY0) y0 = Ctx->ClipY0;
+    if (y1 > Ctx->ClipY1) y1 = Ctx->ClipY1;
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+    INT32 width = x1 - x0 + 1 - n;
+    INT32 height = y1 - y0 + 1;
+    if (width > 0) {
+        if (Ctx->RenderToScreen) {
+            EFI_STATUS Status = gGop->Blt(gGop, NULL, EfiBltVideoToVideo, x0 + n, y0, x0, y0, width, height, 0);
+            if (EFI_ERROR(Status)) {
+                DbgPrint(DL_ERROR, "%a(), Blt() => %a\n", __func__, EFIStatusToStr(Status));
+            }
+        } else {
+            UINT32 *ptr = Ctx->RenBuf->PixelData + x0 + (y0 * Ctx->RenBuf->PixPerScnLn);
+            INT32 h = height;
+            while (h--) {
+                CopyMem(ptr, ptr + n, width * sizeof(UINT32));
+                ptr += Ctx->RenBuf->PixPerScnLn;
+            }
+        }
+    }
+    draw_fill_rectangle(Ctx, (width > 0) ? x0 + width : x0, y0, x1, y1, colour);
+}
+
+EFI_STATUS DrawHeatmap(CONST VOID *Cells, HEATMAP_FORMAT Format, UINT32 Cols, UINT32 Rows, UINT32 Pitch, CONST UINT32 *Lut, UINT32 LutSize, INT32 x0, INT32 y0, INT32 x1, INT32 y1)
+{
+    DbgPrint(DL_INFO, "%a(Cells=0x%p, Format=%d, Cols=%u, Rows=%u, Pitch=%u, Lut=0x%p, LutSize=%u, x0=%d, y0=%d, x1=%d, y1=%d)\n", __func__, Cells, Format, Cols, Rows, Pitch, Lut, LutSize, x0, y0, x1, y1);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_heatmap(&gCurrCtx, Cells, Format, Cols, Rows, Pitch, Lut, LutSize, x0, y0, x1, y1);
+}
+
+EFI_STATUS CtxDrawHeatmap(GFX_CONTEXT *Ctx, CONST VOID *Cells, HEATMAP_FORMAT Format, UINT32 Cols, UINT32 Rows, UINT32 Pitch, CONST UINT32 *Lut, UINT32 LutSize, INT32 x0, INT32 y0, INT32 x1, INT32 y1)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Cells=0x%p, Format=%d, Cols=%u, Rows=%u, Pitch=%u, Lut=0x%p, LutSize=%u, x0=%d, y0=%d, x1=%d, y1=%d)\n", __func__, Ctx, Cells, Format, Cols, Rows, Pitch, Lut, LutSize, x0, y0, x1, y1);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_heatmap(Ctx, Cells, Format, Cols, Rows, Pitch, Lut, LutSize, x0, y0, x1, y1);
+}
+
+/*
+ * draw_heatmap() - nearest neighbour scale cells through colour LUT into rectangle
+ *
+ * The source column of every destination column is worked out once up front,
+ * and destination rows that land on the same source row are copied from the
+ * row before rather than looked up again. Cell values beyond the end of the
+ * LUT use the last entry.
+ */
+STATIC EFI_STATUS draw_heatmap(GFX_CONTEXT *Ctx, CONST VOID *Cells, HEATMAP_FORMAT Format, UINT32 Cols, UINT32 Rows, UINT32 Pitch, CONST UINT32 *Lut, UINT32 LutSize, INT32 x0, INT32 y0, INT32 x1, INT32 y1)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Cells=0x%p, Format=%d, Cols=%u, Rows=%u, Pitch=%u, Lut=0x%p, LutSize=%u, x0=%d, y0=%d, x1=%d, y1=%d)\n", __func__, Ctx, Cells, Format, Cols, Rows, Pitch, Lut, LutSize, x0, y0, x1, y1);
+
+    if (!Cells || !Lut || LutSize == 0 || Cols == 0 || Rows == 0 || Pitch < Cols || Format >= NUM_HEATMAP_FORMATS) {
+        DbgPrint(DL_ERROR, "%a(), invalid parameter => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    // determine top-left and bottom-right
+    if (x1 < x0) {
+        SWAP(INT32, x0, x1);
+    }
+    if (y1 < y0) {
+        SWAP(INT32, y0, y1);
+    }
+    UINT32 dw = x1 - x0 + 1;
+    UINT32 dh = y1 - y0 + 1;
+    // clip rectangle
+    INT32 xl = (x0 < Ctx->ClipX0) ? Ctx->ClipX0 : x0;
+    INT32 xr = (x1 > Ctx->ClipX1) ? Ctx->ClipX1 : x1;
+    INT32 yt = (y0 < Ctx->ClipY0) ? Ctx->ClipY0 : y0;
+    INT32 yb = (y1 > Ctx->ClipY1) ? Ctx->ClipY1 : y1;
+    if (xl > xr || yt > yb) {
+        return EFI_SUCCESS;
+    }
+    UINT32 width = xr - xl + 1;
+    // screen rows are built in a line buffer so the frame buffer is only written
+    UINT32 *XMap = AllocatePool(width * sizeof(UINT32));
+    UINT32 *Line = Ctx->RenderToScreen ? AllocatePool(width * sizeof(UINT32)) : NULL;
+    if (!XMap || (Ctx->RenderToScreen && !Line)) {
+        DbgPrint(DL_ERROR, "%a(), AllocatePool() failed => EFI_OUT_OF_RESOURCES\n", __func__);
+        if (XMap) {
+            FreePool(XMap);
+        }
+        if (Line) {
+            FreePool(Line);
+        }
+        return EFI_OUT_OF_RESOURCES;
+    }
+    for (UINT32 i = 0; i < width; i++) {
+        XMap[i] = (UINT32)DivU64x32(MultU64x32(xl - x0 + i, Cols), dw);
+    }
+    UINT32 MaxIdx = LutSize - 1;
+    UINT32 PrevRow = MAX_UINT32;
+    UINT32 *src = NULL;
+    UINT32 *ptr = Ctx->RenBuf->PixelData + xl + (yt * Ctx->RenBuf->PixPerScnLn);
+
+    EDK2SIM_GFX_BEGIN;
+    for (INT32 y = yt; y <= yb; y++) {
+        UINT32 Row = (UINT32)DivU64x32(MultU64x32(y - y0, Rows), dh);
+        if (Row != PrevRow) {
+            UINT32 *dst = Line ? Line : ptr;
+            if (Format == HEATMAP_U8) {
+                CONST UINT8 *Cell = (CONST UINT8 *)Cells + (UINTN)Row * Pitch;
+                if (MaxIdx >= MAX_UINT8) {
+                    for (UINT32 i = 0; i < width; i++) {
+                        dst[i] = Lut[Cell[XMap[i]]];
+                    }
+                } else {
+                    for (UINT32 i = 0; i < width; i++) {
+                        UINT32 v = Cell[XMap[i]];
+                        dst[i] = Lut[(v < MaxIdx) ? v : MaxIdx];
+                    }
+                }
+            } else {
+                CONST UINT16 *Cell = (CONST UINT16 *)Cells + (UINTN)Row * Pitch;
+                for (UINT32 i = 0; i < width; i++) {
+                    UINT32 v = Cell[XMap[i]];
+                    dst[i] = Lut[(v < MaxIdx) ? v : MaxIdx];
+                }
+            }
+            src = dst;
+            PrevRow = Row;
+        }
+        if (src != ptr) {
+            CopyMem(ptr, src, width * sizeof(UINT32));
+        }
+        ptr += Ctx->RenBuf->PixPerScnLn;
+    }
+    EDK2SIM_GFX_END;
+
+    FreePool(XMap);
+    if (Line) {
+        FreePool(Line);
+    }
+    return EFI_SUCCESS;
+}
+
+EFI_STATUS DrawFillPolygon(CONST POINT *Points, UINTN Count, FILL_RULE Rule, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Points=0x%p, Count=%u, Rule=%u, colour=0x%08X)\n", __func__, Points, Count, Rule, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_fill_polygon(&gCurrCtx, Points, &Count, 1, 0, Rule, colour, NULL);
+}
+
+EFI_STATUS CtxDrawFillPolygon(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, FILL_RULE Rule, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Points=0x%p, Count=%u, Rule=%u, colour=0x%08X)\n", __func__, Ctx, Points, Count, Rule, colour);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_fill_polygon(Ctx, Points, &Count, 1, 0, Rule, colour, NULL);
+}
+
+EFI_STATUS DrawFillPolyPolygon(CONST POINT *Points, CONST UINTN *Counts, UINTN NumContours, FILL_RULE Rule, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Points=0x%p, Counts=0x%p, NumContours=%u, Rule=%u, colour=0x%08X)\n", __func__, Points, Counts, NumContours, Rule, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_fill_polygon(&gCurrCtx, Points, Counts, NumContours, 0, Rule, colour, NULL);
+}
+
+EFI_STATUS CtxDrawFillPolyPolygon(GFX_CONTEXT *Ctx, CONST POINT *Points, CONST UINTN *Counts, UINTN NumContours, FILL_RULE Rule, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Points=0x%p, Counts=0x%p, NumContours=%u, Rule=%u, colour=0x%08X)\n", __func__, Ctx, Points, Counts, NumContours, Rule, colour);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_fill_polygon(Ctx, Points, Counts, NumContours, 0, Rule, colour, NULL);
+}
+
+/*
+ * draw_fill_polygon() - fill closed contours with an edge table and active edge list
+ *
+ * Points have Shift fraction bits, 0 for points at pixel centres or
+ * SUBPIXEL_BITS for points as PIXEL_TO_SUBPIXEL(). Pixels are covered by the
+ * same top-left rule as draw_mesh_triangle() so polygons sharing edges
+ * neither overlap nor leave gaps. Edges are bucketed by first visible row
+ * (counting sort), each row's new edges are sorted and merged into the active
+ * list in one pass, and each row only touches the active edges, so cost is in
+ * proportion to edges plus rows plus covered pixels (plus crossings, as the
+ * active list is kept in order by insertion sort).
+ */
+STATIC EFI_STATUS draw_fill_polygon(GFX_CONTEXT *Ctx, CONST POINT *Points, CONST UINTN *Counts, UINTN NumContours, UINT32 Shift, FILL_RULE Rule, UINT32 colour, CONST BRUSH *Brush)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Points=0x%p, Counts=0x%p, NumContours=%u, Shift=%u, Rule=%u, colour=0x%08X, Brush=0x%p)\n", __func__, Ctx, Points, Counts, NumContours, Shift, Rule, colour, Brush);
+
+    if (!Points || !Counts || Rule >= NUM_FILL_RULES) {
+        DbgPrint(DL_ERROR, "%a(), invalid parameter => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    UINTN Total = 0;
+    for (UINTN c = 0; c < NumContours; c++) {
+        Total += Counts[c];
+    }
+    for (UINTN i = 0; i < Total; i++) {
+        if (ABS(Points[i].X) > POLY_MAX_ORD || ABS(Points[i].Y) > POLY_MAX_ORD) {
+            DbgPrint(DL_ERROR, "%a(), Points[%u] out of range => EFI_INVALID_PARAMETER\n", __func__, i);
+            return EFI_INVALID_PARAMETER;
+        }
+    }
+    if (Total < 3) {
+        return EFI_SUCCESS;
+    }
+    UINTN NumRows = Ctx->ClipY1 - Ctx->ClipY0 + 1;
+    POLY_EDGE *Edges = AllocatePool(Total * sizeof(POLY_EDGE));
+    POLY_EDGE **Table = AllocatePool(Total * sizeof(POLY_EDGE *));
+    POLY_EDGE **Active = AllocatePool(Total * sizeof(POLY_EDGE *));
+    UINT32 *Bucket = AllocateZeroPool((NumRows + 1) * sizeof(UINT32));
+    if (!Edges || !Table || !Active || !Bucket) {
+        DbgPrint(DL_ERROR, "%a(), memory allocation error => EFI_OUT_OF_RESOURCES\n", __func__);
+        if (Edges) {
+            FreePool(Edges);
+        }
+        if (Table) {
+            FreePool(Table);
+        }
+        if (Active) {
+            FreePool(Active);
+        }
+        if (Bucket) {
+            FreePool(Bucket);
+        }
+        return EFI_OUT_OF_RESOURCES;
+    }
+    // edge table, edges sorted by first row (held in Bound.Q's row until activated)
+    UINTN NumEdges = build_edge_table(Ctx, Points, Counts, NumContours, Shift, Edges);
+    for (UINTN i = 0; i < NumEdges; i++) {
+        Bucket[(UINTN)(Edges[i].X - Ctx->ClipY0) + 1]++;
+    }
+    for (UINTN r = 1; r <= NumRows; r++) {
+        Bucket[r] += Bucket[r - 1];
+    }
+    for (UINTN i = 0; i < NumEdges; i++) {
+        Table[Bucket[(UINTN)(Edges[i].X - Ctx->ClipY0)]++] = &Edges[i];
+    }
+    // Bucket[r] is now the end of row r's edges
+
+    EDK2SIM_GFX_BEGIN;
+    UINTN Next = 0;
+    UINTN NumActive = 0;
+    INT32 y = Ctx->ClipY0;
+    while (Next < NumEdges || NumActive) {
+        if (!NumActive) {
+            // skip empty rows
+            y = (INT32)(Table[Next]->X);
+        }
+        // first pixel right of each edge, insertion sort as order rarely changes between rows
+        for (UINTN i = 0; i < NumActive; i++) {
+            POLY_EDGE *Edge = Active[i];
+            Edge->X = Edge->Bound.Q + (Edge->Bound.R ? 1 : 0);
+            UINTN j = i;
+            while (j > 0 && Active[j - 1]->X > Edge->X) {
+                Active[j] = Active[j - 1];
+                j--;
+            }
+            Active[j] = Edge;
+        }
+        // edges starting on this row are sorted on their own then merged in from the back
+        UINTN End = Bucket[y - Ctx->ClipY0];
+        if (Next < End) {
+            POLY_EDGE **New = &Table[Next];
+            UINTN NumNew = End - Next;
+            for (UINTN k = 0; k < NumNew; k++) {
+                New[k]->X = New[k]->Bound.Q + (New[k]->Bound.R ? 1 : 0);
+            }
+            sort_edges(New, NumNew);
+            UINTN i = NumActive;
+            UINTN j = NumNew;
+            UINTN k = NumActive + NumNew;
+            while (j > 0) {
+                if (i > 0 && Active[i - 1]->X > New[j - 1]->X) {
+                    Active[--k] = Active[--i];
+                } else {
+                    Active[--k] = New[--j];
+                }
+            }
+            NumActive += NumNew;
+            Next = End;
+        }
+        fill_polygon_row(Ctx, Active, NumActive, y, Rule, colour, Brush);
+        y++;
+        // step active edges, dropping those that have ended
+        UINTN n = 0;
+        for (UINTN i = 0; i < NumActive; i++) {
+            POLY_EDGE *Edge = Active[i];
+            if (Edge->YBot <= y) {
+                continue;
+            }
+            RASTER_BOUND *Bound = &Edge->Bound;
+            Bound->Q += Bound->Dq;
+            Bound->R += Bound->Dr;
+            if (Bound->R >= Bound->S) {
+                Bound->R -= Bound->S;
+                Bound->Q++;
+            }
+            Active[n++] = Edge;
+        }
+        NumActive = n;
+    }
+    EDK2SIM_GFX_END;
+
+    FreePool(Edges);
+    FreePool(Table);
+    FreePool(Active);
+    FreePool(Bucket);
+    return EFI_SUCCESS;
+}
+
+/*
+ * build_edge_table() - set up visible non-horizontal edges at their first visible row, returns number of edges
+ *
+ * Edges are half open, covering rows from the upper vertex down to but not
+ * including the lower one. Until activated POLY_EDGE.X holds the first row.
+ * With Shift fraction bits, coords are first moved so pixel centres are
+ * whole multiples of 1 << Shift, then each pixel is 1 << Shift units.
+ */
+STATIC UINTN build_edge_table(GFX_CONTEXT *Ctx, CONST POINT *Points, CONST UINTN *Counts, UINTN NumContours, UINT32 Shift, POLY_EDGE *Edges)
+{
+    INT64 One = (INT64)1 << Shift;
+    INT64 Half = One >> 1;
+    UINTN NumEdges = 0;
+
+    for (UINTN c = 0; c < NumContours; c++) {
+        UINTN Count = Counts[c];
+        for (UINTN i = 0; i < Count; i++) {
+            CONST POINT *A = &Points[i];
+            CONST POINT *B = &Points[(i + 1 < Count) ? i + 1 : 0];
+            if (A->Y == B->Y) {
+                continue;
+            }
+            INT32 Winding = 1;
+            if (A->Y > B->Y) {
+                SWAP(CONST POINT *, A, B);
+                Winding = -1;
+            }
+            INT64 Ax = (INT64)A->X - Half;
+            INT64 Ay = (INT64)A->Y - Half;
+            INT64 By = (INT64)B->Y - Half;
+            // rows whose centre is in [Ay, By)
+            INT64 yTop = ARShiftU64(Ay + One - 1, Shift);
+            INT64 yEnd = ARShiftU64(By + One - 1, Shift);
+            if (yTop >= yEnd || yEnd <= Ctx->ClipY0 || yTop > Ctx->ClipY1) {
+                continue;
+            }
+            INT64 y = (yTop < Ctx->ClipY0) ? Ctx->ClipY0 : yTop;
+            INT64 Dx = (INT64)B->X - A->X;
+            INT64 Ix = ARShiftU64(Ax, Shift);
+            POLY_EDGE *Edge = &Edges[NumEdges++];
+            Edge->Bound.S = (By - Ay) * One;
+            Edge->Bound.Q = Ix + floor_div((Ax - Ix * One) * (By - Ay) + Dx * (y * One - Ay), Edge->Bound.S, &Edge->Bound.R);
+            Edge->Bound.Dq = floor_div(Dx * One, Edge->Bound.S, &Edge->Bound.Dr);
+            Edge->YBot = (yEnd > Ctx->ClipY1) ? Ctx->ClipY1 + 1 : (INT32)yEnd;
+            Edge->Winding = Winding;
+            Edge->X = y;
+        }
+        Points += Count;
+    }
+    return NumEdges;
+}
+
+/*
+ * sort_edges() - heap sort edges by X
+ */
+STATIC VOID sort_edges(POLY_EDGE **Edges, UINTN Count)
+{
+    for (UINTN n = Count / 2; n > 0; n--) {
+        sift_edge(Edges, n - 1, Count);
+    }
+    // largest to the end each pass
+    for (UINTN n = Count; n > 1; n--) {
+        SWAP(POLY_EDGE *, Edges[0], Edges[n - 1]);
+        sift_edge(Edges, 0, n - 1);
+    }
+}
+
+/*
+ * sift_edge() - move Edges[i] down the max heap of Count edges until it is in order
+ */
+STATIC VOID sift_edge(POLY_EDGE **Edges, UINTN i, UINTN Count)
+{
+    POLY_EDGE *Edge = Edges[i];
+    for (;;) {
+        UINTN c = (2 * i) + 1;
+        if (c >= Count) {
+            break;
+        }
+        if (c + 1 < Count && Edges[c + 1]->X > Edges[c]->X) {
+            c++;
+        }
+        if (Edges[c]->X <= Edge->X) {
+            break;
+        }
+        Edges[i] = Edges[c];
+        i = c;
+    }
+    Edges[i] = Edge;
+}
+
+/*
+ * fill_polygon_row() - fill spans between active edges (sorted by X) that are inside by Rule, with colour or Brush
+ */
+STATIC VOID fill_polygon_row(GFX_CONTEXT *Ctx, POLY_EDGE **Active, UINTN NumActive, INT32 y, FILL_RULE Rule, UINT32 colour, CONST BRUSH *Brush)
+{
+    UINT32 *ptr = Ctx->RenBuf->PixelData + (y * Ctx->RenBuf->PixPerScnLn);
+    INT32 Winding = 0;
+    INT64 xl = 0;
+
+    for (UINTN i = 0; i < NumActive; i++) {
+        BOOLEAN Inside = (Winding != 0);
+        Winding = (Rule == FILL_EVEN_ODD) ? (Winding ^ 1) : (Winding + Active[i]->Winding);
+        if (Inside == (Winding != 0)) {
+            continue;
+        }
+        if (!Inside) {
+            xl = Active[i]->X;
+            continue;
+        }
+        // span [xl, X) clipped
+        INT64 xr = Active[i]->X - 1;
+        if (xl < Ctx->ClipX0) xl = Ctx->ClipX0;
+        if (xr > Ctx->ClipX1) xr = Ctx->ClipX1;
+        if (xl <= xr && Brush) {
+            brush_span(Brush, ptr, xl, xr, y);
+        } else if (xl <= xr) {
+            SetMem32(ptr + xl, (UINTN)(xr - xl + 1) * sizeof(UINT32), colour);
+        }
+    }
+}
+
+EFI_STATUS DrawThickLine(INT32 x0, INT32 y0, INT32 x1, INT32 y1, CONST PEN *Pen, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(x0=%d, y0=%d, x1=%d, y1=%d, Pen=0x%p, colour=0x%08X)\n", __func__, x0, y0, x1, y1, Pen, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    POINT Points[2] = { { x0, y0 }, { x1, y1 } };
+    return draw_thick_polyline(&gCurrCtx, Points, 2, Pen, colour);
+}
+
+EFI_STATUS CtxDrawThickLine(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, CONST PEN *Pen, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x0=%d, y0=%d, x1=%d, y1=%d, Pen=0x%p, colour=0x%08X)\n", __func__, Ctx, x0, y0, x1, y1, Pen, colour);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    POINT Points[2] = { { x0, y0 }, { x1, y1 } };
+    return draw_thick_polyline(Ctx, Points, 2, Pen, colour);
+}
+
+EFI_STATUS DrawThickPolyline(CONST POINT *Points, UINTN Count, CONST PEN *Pen, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Points=0x%p, Count=%u, Pen=0x%p, colour=0x%08X)\n", __func__, Points, Count, Pen, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_thick_polyline(&gCurrCtx, Points, Count, Pen, colour);
+}
+
+EFI_STATUS CtxDrawThickPolyline(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, CONST PEN *Pen, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Points=0x%p, Count=%u, Pen=0x%p, colour=0x%08X)\n", __func__, Ctx, Points, Count, Pen, colour);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_thick_polyline(Ctx, Points, Count, Pen, colour);
+}
+
+/*
+ * draw_thick_polyline() - stroke polyline with Pen, all pieces filled together so none overlap or leave gaps
+ *
+ * Segments, caps and joins become convex contours in 28.4 that are filled
+ * as one non-zero polygon by draw_fill_polygon(), so each covered pixel is
+ * written once. One pixel wide pens draw their pieces with clip_line().
+ */
+STATIC EFI_STATUS draw_thick_polyline(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, CONST PEN *Pen, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Points=0x%p, Count=%u, Pen=0x%p, colour=0x%08X)\n", __func__, Ctx, Points, Count, Pen, colour);
+
+    if ((!Points && Count) || !Pen || Pen->Width == 0 || Pen->Width > PEN_MAX_WIDTH ||
+        Pen->Cap >= NUM_LINE_CAPS || Pen->Join >= NUM_LINE_JOINS || (Pen->NumDashes && !Pen->Dashes)) {
+        DbgPrint(DL_ERROR, "%a(), invalid parameter => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    UINT64 Pattern = 0;
+    for (UINTN d = 0; d < Pen->NumDashes; d++) {
+        if (Pen->Dashes[d] > PEN_MAX_ORD) {
+            DbgPrint(DL_ERROR, "%a(), Dashes[%u] out of range => EFI_INVALID_PARAMETER\n", __func__, d);
+            return EFI_INVALID_PARAMETER;
+        }
+        Pattern += Pen->Dashes[d];
+    }
+    if (Pen->NumDashes && Pattern == 0) {
+        DbgPrint(DL_ERROR, "%a(), empty dash pattern => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    for (UINTN i = 0; i < Count; i++) {
+        if (ABS(Points[i].X) > PEN_MAX_ORD || ABS(Points[i].Y) > PEN_MAX_ORD) {
+            DbgPrint(DL_ERROR, "%a(), Points[%u] out of range => EFI_INVALID_PARAMETER\n", __func__, i);
+            return EFI_INVALID_PARAMETER;
+        }
+    }
+    if (Count == 0) {
+        return EFI_SUCCESS;
+    }
+    STROKE Stroke;
+    ZeroMem(&Stroke, sizeof(STROKE));
+    stroke_polyline(Ctx, &Stroke, Points, Count, Pen, colour);
+
+    EFI_STATUS Status = Stroke.Status;
+    if (!EFI_ERROR(Status) && Stroke.NumContours) {
+        Status = draw_fill_polygon(Ctx, Stroke.Points, Stroke.Counts, Stroke.NumContours, SUBPIXEL_BITS, FILL_NON_ZERO, colour, NULL);
+    }
+    if (Stroke.Points) {
+        FreePool(Stroke.Points);
+    }
+    if (Stroke.Counts) {
+        FreePool(Stroke.Counts);
+    }
+    return Status;
+}
+
+/*
+ * stroke_polyline() - walk the polyline and its dash pattern, adding the pieces that are on to Stroke
+ *
+ * Distances are 28.4 along each segment. A dash is carried from segment
+ * to segment by what remains of it, so the pattern is stepped once per
+ * dash rather than tested per pixel. Only the part of each segment near
+ * the clip window is walked, the pattern is skipped over the rest, so a
+ * long dashed line costs what its visible part does.
+ */
+STATIC VOID stroke_polyline(GFX_CONTEXT *Ctx, STROKE *Stroke, CONST POINT *Points, UINTN Count, CONST PEN *Pen, UINT32 colour)
+{
+    BOOLEAN Thin = (Pen->Width == 1);
+    INT64 h = (INT64)Pen->Width * SUBPIXEL_HALF;
+    // caps reach h * sqrt(2) from the centre line, joins are added whole and culled in stroke_add()
+    INT64 Margin = Thin ? SUBPIXEL_ONE : (2 * h) + SUBPIXEL_ONE;
+    UINTN d = 0;
+    BOOLEAN On = TRUE;
+    INT64 Rem = MAX_INT64;
+    INT64 Pattern = 0;
+
+    Stroke->X0 = PIXEL_TO_SUBPIXEL(Ctx->ClipX0);
+    Stroke->Y0 = PIXEL_TO_SUBPIXEL(Ctx->ClipY0);
+    Stroke->X1 = PIXEL_TO_SUBPIXEL(Ctx->ClipX1);
+    Stroke->Y1 = PIXEL_TO_SUBPIXEL(Ctx->ClipY1);
+    if (Pen->NumDashes) {
+        // start DashOffset into the pattern, which repeats after two passes when it has an odd number of dashes
+        for (UINTN i = 0; i < Pen->NumDashes; i++) {
+            Pattern += (INT64)Pen->Dashes[i] * SUBPIXEL_ONE;
+        }
+        if (Pen->NumDashes & 1) {
+            Pattern *= 2;
+        }
+        Rem = (INT64)Pen->Dashes[0] * SUBPIXEL_ONE;
+        Rem -= stroke_skip(Pen, Pattern, (INT64)Pen->DashOffset * SUBPIXEL_ONE, &d, &On, &Rem);
+    }
+
+    BOOLEAN Open = FALSE;       // in a dash that is on
+    BOOLEAN HavePrev = FALSE;
+    INT64 Pdx = 0;
+    INT64 Pdy = 0;
+    INT64 PNx = 0;
+    INT64 PNy = 0;
+    for (UINTN i = 0; i + 1 < Count; i++) {
+        INT64 dx = (INT64)Points[i + 1].X - Points[i].X;
+        INT64 dy = (INT64)Points[i + 1].Y - Points[i].Y;
+        if (dx == 0 && dy == 0) {
+            continue;
+        }
+        INT64 Ax = PIXEL_TO_SUBPIXEL(Points[i].X);
+        INT64 Ay = PIXEL_TO_SUBPIXEL(Points[i].Y);
+        INT64 Len = (INT64)isqrt64((UINT64)(dx * dx + dy * dy) << (2 * SUBPIXEL_BITS));
+        // normal, h long
+        INT64 Nx = DivS64x64Remainder(-dy * SUBPIXEL_ONE * h, Len, NULL);
+        INT64 Ny = DivS64x64Remainder(dx * SUBPIXEL_ONE * h, Len, NULL);
+        if (Open && HavePrev && !Thin) {
+            stroke_join(Stroke, Pen->Join, h, Ax, Ay, PNx, PNy, Nx, Ny, (Pdx * dy) - (Pdy * dx));
+        }
+        // dashes wholly before Enter or after Leave are skipped, the ones across them are added whole
+        INT64 Enter;
+        INT64 Leave;
+        if (!stroke_window(Stroke, Ax, Ay, dx * SUBPIXEL_ONE, dy * SUBPIXEL_ONE, Len, Margin, &Enter, &Leave)) {
+            Enter = Len;
+            Leave = Len;
+        }
+        INT64 Pos = Enter - stroke_skip(Pen, Pattern, Enter, &d, &On, &Rem);
+        if (Pos > 0) {
+            // at the start of a dash, the one before ended
+            Open = FALSE;
+        }
+        while (Pos < Leave) {
+            INT64 Step = MIN(Rem, Len - Pos);
+            if (On) {
+                INT64 x0 = Ax + DivS64x64Remainder(dx * SUBPIXEL_ONE * Pos, Len, NULL);
+                INT64 y0 = Ay + DivS64x64Remainder(dy * SUBPIXEL_ONE * Pos, Len, NULL);
+                INT64 x1 = Ax + DivS64x64Remainder(dx * SUBPIXEL_ONE * (Pos + Step), Len, NULL);
+                INT64 y1 = Ay + DivS64x64Remainder(dy * SUBPIXEL_ONE * (Pos + Step), Len, NULL);
+                if (Thin) {
+                    // pixels from the start up to but not including the end, unless it ends the polyline
+                    if (!(Pos + Step == Len && i + 2 == Count && Step < Rem)) {
+                        INT64 Back = MIN(Step, SUBPIXEL_ONE);
+                        x1 -= DivS64x64Remainder(dx * SUBPIXEL_ONE * Back, Len, NULL);
+                        y1 -= DivS64x64Remainder(dy * SUBPIXEL_ONE * Back, Len, NULL);
+                    }
+                    clip_line(Ctx, (INT32)ARShiftU64(x0, SUBPIXEL_BITS), (INT32)ARShiftU64(y0, SUBPIXEL_BITS),
+                              (INT32)ARShiftU64(x1, SUBPIXEL_BITS), (INT32)ARShiftU64(y1, SUBPIXEL_BITS), colour);
+                } else {
+                    if (!Open) {
+                        stroke_cap(Stroke, Pen->Cap, h, x0, y0, Nx, Ny, TRUE);
+                    }
+                    INT64 X[4] = { x0 + Nx, x1 + Nx, x1 - Nx, x0 - Nx };
+                    INT64 Y[4] = { y0 + Ny, y1 + Ny, y1 - Ny, y0 - Ny };
+                    stroke_add(Stroke, X, Y, 4);
+                    if (Step == Rem) {
+                        stroke_cap(Stroke, Pen->Cap, h, x1, y1, Nx, Ny, FALSE);
+                    }
+                }
+                Open = (Step < Rem);
+            }
+            Pos += Step;
+            Rem -= Step;
+            if (Rem) {
+                // segment done part way through a dash
+                break;
+            }
+            d = (d + 1 < Pen->NumDashes) ? d + 1 : 0;
+            On = !On;
+            Rem = (INT64)Pen->Dashes[d] * SUBPIXEL_ONE;
+        }
+        if (Pos < Len) {
+            Rem -= stroke_skip(Pen, Pattern, Len - Pos, &d, &On, &Rem);
+            Open = On;
+        }
+        Pdx = dx;
+        Pdy = dy;
+        PNx = Nx;
+        PNy = Ny;
+        HavePrev = TRUE;
+    }
+    if (!Thin && Open) {
+        INT64 x = PIXEL_TO_SUBPIXEL(Points[Count - 1].X);
+        INT64 y = PIXEL_TO_SUBPIXEL(Points[Count - 1].Y);
+        stroke_cap(Stroke, Pen->Cap, h, x, y, PNx, PNy, FALSE);
+    } else if (!HavePrev && On) {
+        // all points the same, a dot as round or square caps would draw
+        INT64 x = PIXEL_TO_SUBPIXEL(Points[0].X);
+        INT64 y = PIXEL_TO_SUBPIXEL(Points[0].Y);
+        if (Thin) {
+            clip_line(Ctx, Points[0].X, Points[0].Y, Points[0].X, Points[0].Y, colour);
+        } else if (Pen->Cap != LINE_CAP_BUTT) {
+            stroke_cap(Stroke, Pen->Cap, h, x, y, 0, h, TRUE);
+            stroke_cap(Stroke, Pen->Cap, h, x, y, 0, h, FALSE);
+        }
+    }
+}
+
+/*
+ * stroke_window() - find where segment A + (Dx, Dy) Pos / Len is within Margin of Stroke's clip window
+ *
+ * Liang-Barsky on the centre line, with Enter rounded down and Leave up.
+ * Returns FALSE when no part of the segment is that close.
+ */
+STATIC BOOLEAN stroke_window(CONST STROKE *Stroke, INT64 Ax, INT64 Ay, INT64 Dx, INT64 Dy, INT64 Len, INT64 Margin, INT64 *Enter, INT64 *Leave)
+{
+    INT64 A[2] = { Ax, Ay };
+    INT64 D[2] = { Dx, Dy };
+    INT64 Lo[2] = { Stroke->X0 - Margin, Stroke->Y0 - Margin };
+    INT64 Hi[2] = { Stroke->X1 + Margin, Stroke->Y1 + Margin };
+    INT64 In = 0;
+    INT64 Out = Len;
+
+    for (UINTN k = 0; k < 2; k++) {
+        if (D[k] == 0) {
+            if (A[k] < Lo[k] || A[k] > Hi[k]) {
+                return FALSE;
+            }
+            continue;
+        }
+        INT64 P0 = DivS64x64Remainder((Lo[k] - A[k]) * Len, D[k], NULL);
+        INT64 P1 = DivS64x64Remainder((Hi[k] - A[k]) * Len, D[k], NULL);
+        In = MAX(In, MIN(P0, P1) - 1);
+        Out = MIN(Out, MAX(P0, P1) + 1);
+    }
+    if (In >= Out) {
+        return FALSE;
+    }
+    *Enter = In;
+    *Leave = Out;
+    return TRUE;
+}
+
+/*
+ * stroke_skip() - step the dash state past the dashes that end within Dist (28.4), returns what is left of Dist
+ *
+ * Whole repeats of the pattern are dropped with one division, so the cost
+ * does not grow with Dist.
+ */
+STATIC INT64 stroke_skip(CONST PEN *Pen, INT64 Pattern, INT64 Dist, UINTN *d, BOOLEAN *On, INT64 *Rem)
+{
+    if (Dist < *Rem) {
+        // always so for a solid line
+        return Dist;
+    }
+    Dist -= *Rem;
+    *d = (*d + 1 < Pen->NumDashes) ? *d + 1 : 0;
+    *On = !*On;
+    *Rem = (INT64)Pen->Dashes[*d] * SUBPIXEL_ONE;
+    DivS64x64Remainder(Dist, Pattern, &Dist);
+    while (Dist >= *Rem) {
+        Dist -= *Rem;
+        *d = (*d + 1 < Pen->NumDashes) ? *d + 1 : 0;
+        *On = !*On;
+        *Rem = (INT64)Pen->Dashes[*d] * SUBPIXEL_ONE;
+    }
+    return Dist;
+}
+
+/*
+ * stroke_cap() - add cap at (x, y) for a piece with normal (Nx, Ny), before the piece if Start
+ */
+STATIC VOID stroke_cap(STROKE *Stroke, LINE_CAP Cap, INT64 h, INT64 x, INT64 y, INT64 Nx, INT64 Ny, BOOLEAN Start)
+{
+    if (Cap == LINE_CAP_ROUND) {
+        stroke_circle(Stroke, x, y, h);
+    } else if (Cap == LINE_CAP_SQUARE) {
+        // along the line, h long
+        INT64 Ux = Start ? -Ny : Ny;
+        INT64 Uy = Start ? Nx : -Nx;
+        INT64 X[4] = { x + Nx, x + Nx + Ux, x - Nx + Ux, x - Nx };
+        INT64 Y[4] = { y + Ny, y + Ny + Uy, y - Ny + Uy, y - Ny };
+        stroke_add(Stroke, X, Y, 4);
+    }
+}
+
+/*
+ * stroke_join() - add join at (x, y) from a segment with normal (N1x, N1y) to one with (N2x, N2y)
+ *
+ * Cross is the cross product of the segments' directions, which is
+ * positive when the outer corner is on the side away from the normals.
+ */
+STATIC VOID stroke_join(STROKE *Stroke, LINE_JOIN Join, INT64 h, INT64 x, INT64 y, INT64 N1x, INT64 N1y, INT64 N2x, INT64 N2y, INT64 Cross)
+{
+    INT64 Dot = (N1x * N2x) + (N1y * N2y);
+    if (Cross == 0 && Dot > 0) {
+        // straight on
+        return;
+    }
+    if (Join == LINE_JOIN_ROUND) {
+        stroke_circle(Stroke, x, y, h);
+        return;
+    }
+    INT64 s = (Cross > 0) ? -1 : 1;
+    INT64 O1x = s * N1x;
+    INT64 O1y = s * N1y;
+    INT64 O2x = s * N2x;
+    INT64 O2y = s * N2y;
+    INT64 h2 = h * h;
+    // miter tip is h / sin(half the angle between segments) out, within PEN_MITER_LIMIT * h when 2h^2 <= limit^2 (h^2 + Dot)
+    if (Join == LINE_JOIN_MITER && Cross != 0 && 2 * h2 <= PEN_MITER_LIMIT * PEN_MITER_LIMIT * (h2 + Dot)) {
+        INT64 Mx = x + DivS64x64Remainder((O1x + O2x) * h2, h2 + Dot, NULL);
+        INT64 My = y + DivS64x64Remainder((O1y + O2y) * h2, h2 + Dot, NULL);
+        INT64 X[4] = { x, x + O1x, Mx, x + O2x };
+        INT64 Y[4] = { y, y + O1y, My, y + O2y };
+        stroke_add(Stroke, X, Y, 4);
+    } else {
+        INT64 X[3] = { x, x + O1x, x + O2x };
+        INT64 Y[3] = { y, y + O1y, y + O2y };
+        stroke_add(Stroke, X, Y, 3);
+    }
+}
+
+/*
+ * stroke_circle() - add circle radius r (28.4) as a polygon within about 1/4 pixel of it
+ *
+ * A chord across 360/n degrees sags r(1 - cos(180/n)), about 5r/n^2.
+ */
+STATIC VOID stroke_circle(STROKE *Stroke, INT64 x, INT64 y, INT64 r)
+{
+    INT64 X[PEN_MAX_ARC];
+    INT64 Y[PEN_MAX_ARC];
+    UINTN n = 8 + (5 * (UINTN)isqrt64((UINT64)r >> SUBPIXEL_BITS));
+    n = MIN(n & ~(UINTN)3, PEN_MAX_ARC);
+
+    for (UINTN i = 0; i < n; i++) {
+        INT32 Angle = (INT32)((i * 3600) / n);
+        X[i] = x + ARShiftU64(r * fixed_sin(Angle + 900), 16);
+        Y[i] = y + ARShiftU64(r * fixed_sin(Angle), 16);
+    }
+    stroke_add(Stroke, X, Y, n);
+}
+
+/*
+ * stroke_add() - add convex contour, all wound the same way so non-zero filling gives their union
+ *
+ * Contours that cover no pixel centre in the clip window cannot change
+ * the union there and are dropped.
+ */
+STATIC VOID stroke_add(STROKE *Stroke, CONST INT64 *X, CONST INT64 *Y, UINTN Count)
+{
+    if (EFI_ERROR(Stroke->Status)) {
+        return;
+    }
+    INT64 MinX = X[0];
+    INT64 MaxX = X[0];
+    INT64 MinY = Y[0];
+    INT64 MaxY = Y[0];
+    INT64 Area = 0;
+    for (UINTN i = 0; i < Count; i++) {
+        UINTN j = (i + 1 < Count) ? i + 1 : 0;
+        Area += (X[i] * Y[j]) - (X[j] * Y[i]);
+        MinX = MIN(MinX, X[i]);
+        MaxX = MAX(MaxX, X[i]);
+        MinY = MIN(MinY, Y[i]);
+        MaxY = MAX(MaxY, Y[i]);
+    }
+    if (Area == 0 || MaxX < Stroke->X0 || MinX > Stroke->X1 || MaxY < Stroke->Y0 || MinY > Stroke->Y1) {
+        return;
+    }
+    if (Stroke->NumPoints + Count > Stroke->MaxPoints) {
+        if (Stroke->NumPoints + Count > STROKE_MAX_POINTS) {
+            DbgPrint(DL_ERROR, "%a(), too many points => EFI_OUT_OF_RESOURCES\n", __func__);
+            Stroke->Status = EFI_OUT_OF_RESOURCES;
+            return;
+        }
+        UINTN Max = MIN(MAX(Stroke->MaxPoints * 2, Stroke->NumPoints + Count + 64), STROKE_MAX_POINTS);
+        POINT *Points = ReallocatePool(Stroke->MaxPoints * sizeof(POINT), Max * sizeof(POINT), Stroke->Points);
+        if (!Points) {
+            DbgPrint(DL_ERROR, "%a(), memory allocation error => EFI_OUT_OF_RESOURCES\n", __func__);
+            Stroke->Status = EFI_OUT_OF_RESOURCES;
+            return;
+        }
+        Stroke->Points = Points;
+        Stroke->MaxPoints = Max;
+    }
+    if (Stroke->NumContours == Stroke->MaxContours) {
+        UINTN Max = Stroke->MaxContours ? Stroke->MaxContours * 2 : 16;
+        UINTN *Counts = ReallocatePool(Stroke->MaxContours * sizeof(UINTN), Max * sizeof(UINTN), Stroke->Counts);
+        if (!Counts) {
+            DbgPrint(DL_ERROR, "%a(), memory allocation error => EFI_OUT_OF_RESOURCES\n", __func__);
+            Stroke->Status = EFI_OUT_OF_RESOURCES;
+            return;
+        }
+        Stroke->Counts = Counts;
+        Stroke->MaxContours = Max;
+    }
+    POINT *P = &Stroke->Points[Stroke->NumPoints];
+    for (UINTN i = 0; i < Count; i++) {
+        UINTN k = (Area > 0) ? i : Count - 1 - i;
+        P[i].X = (INT32)X[k];
+        P[i].Y = (INT32)Y[k];
+    }
+    Stroke->NumPoints += Count;
+    Stroke->Counts[Stroke->NumContours++] = Count;
+}
+
+EFI_STATUS CreatePath(GFX_PATH *Path)
+{
+    DbgPrint(DL_INFO, "%a(Path=0x%p)\n", __func__, Path);
+
+    if (!Path) {
+        DbgPrint(DL_ERROR, "%a(), Path=NULL => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    // storage is allocated as points are added
+    ZeroMem(Path, sizeof(GFX_PATH));
+    Path->Sig = PATH_SIG;
+
+    return EFI_SUCCESS;
+}
+
+EFI_STATUS ResetPath(GFX_PATH *Path)
+{
+    DbgPrint(DL_INFO, "%a(Path=0x%p)\n", __func__, Path);
+
+    if (!check_path(Path)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    // keep storage for reuse
+    Path->NumPoints = 0;
+    Path->NumContours = 0;
+
+    return EFI_SUCCESS;
+}
+
+EFI_STATUS DestroyPath(GFX_PATH *Path)
+{
+    DbgPrint(DL_INFO, "%a(Path=0x%p)\n", __func__, Path);
+
+    if (!check_path(Path)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    if (Path->Points) {
+        FreePool(Path->Points);
+    }
+    if (Path->Contours) {
+        FreePool(Path->Contours);
+    }
+    ZeroMem(Path, sizeof(GFX_PATH));
+
+    return EFI_SUCCESS;
+}
+
+EFI_STATUS PathMoveTo(GFX_PATH *Path, INT32 x, INT32 y)
+{
+    DbgPrint(DL_INFO, "%a(Path=0x%p, x=0x%X, y=0x%X)\n", __func__, Path, x, y);
+
+    if (!check_path(Path)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return path_begin(Path, x, y);
+}
+
+EFI_STATUS PathLineTo(GFX_PATH *Path, INT32 x, INT32 y)
+{
+    DbgPrint(DL_INFO, "%a(Path=0x%p, x=0x%X, y=0x%X)\n", __func__, Path, x, y);
+
+    INT64 x0, y0;
+    EFI_STATUS Status = path_current(Path, &x0, &y0);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    return path_add_point(Path, x, y);
+}
+
+EFI_STATUS PathQuadTo(GFX_PATH *Path, INT32 cx, INT32 cy, INT32 x, INT32 y)
+{
+    DbgPrint(DL_INFO, "%a(Path=0x%p, cx=0x%X, cy=0x%X, x=0x%X, y=0x%X)\n", __func__, Path, cx, cy, x, y);
+
+    INT64 x0, y0;
+    EFI_STATUS Status = path_current(Path, &x0, &y0);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    // the curve stays within its control points
+    if (!check_path_point(cx, cy) || !check_path_point(x, y)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return flatten_quad(Path, x0, y0, cx, cy, x, y, 0);
+}
+
+EFI_STATUS PathCubicTo(GFX_PATH *Path, INT32 c1x, INT32 c1y, INT32 c2x, INT32 c2y, INT32 x, INT32 y)
+{
+    DbgPrint(DL_INFO, "%a(Path=0x%p, c1x=0x%X, c1y=0x%X, c2x=0x%X, c2y=0x%X, x=0x%X, y=0x%X)\n", __func__, Path, c1x, c1y, c2x, c2y, x, y);
+
+    INT64 x0, y0;
+    EFI_STATUS Status = path_current(Path, &x0, &y0);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    // the curve stays within its control points
+    if (!check_path_point(c1x, c1y) || !check_path_point(c2x, c2y) || !check_path_point(x, y)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return flatten_cubic(Path, x0, y0, c1x, c1y, c2x, c2y, x, y, 0);
+}
+
+EFI_STATUS PathClose(GFX_PATH *Path)
+{
+    DbgPrint(DL_INFO, "%a(Path=0x%p)\n", __func__, Path);
+
+    if (!check_path(Path)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    if (Path->NumContours == 0) {
+        DbgPrint(DL_ERROR, "%a(), no current point => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    Path->Contours[Path->NumContours - 1] |= PATH_CLOSED;
+
+    return EFI_SUCCESS;
+}
+
+/*
+ * check_path() - return TRUE if path has been created
+ */
+STATIC BOOLEAN check_path(CONST GFX_PATH *Path)
+{
+    if (!Path || Path->Sig != PATH_SIG) {
+        DbgPrint(DL_ERROR, "%a(), Invalid Path\n", __func__);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * check_path_point() - return TRUE if [x,y] is within PATH_MAX_ORD
+ */
+STATIC BOOLEAN check_path_point(INT64 x, INT64 y)
+{
+    if (ABS(x) > PATH_MAX_ORD || ABS(y) > PATH_MAX_ORD) {
+        DbgPrint(DL_ERROR, "%a(), point out of range\n", __func__);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * path_current() - current point, after a close a new contour starts from the closed contour's first point
+ */
+STATIC EFI_STATUS path_current(GFX_PATH *Path, INT64 *x, INT64 *y)
+{
+    if (!check_path(Path)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    if (Path->NumContours == 0) {
+        DbgPrint(DL_ERROR, "%a(), no current point => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    UINT32 Last = Path->Contours[Path->NumContours - 1];
+    if (Last & PATH_CLOSED) {
+        UINTN Start = (Path->NumContours > 1) ? (Path->Contours[Path->NumContours - 2] & ~PATH_CLOSED) : 0;
+        *x = Path->Points[Start].X;
+        *y = Path->Points[Start].Y;
+        return path_begin(Path, *x, *y);
+    }
+    *x = Path->Points[Path->NumPoints - 1].X;
+    *y = Path->Points[Path->NumPoints - 1].Y;
+    return EFI_SUCCESS;
+}
+
+/*
+ * path_begin() - start a new contour at [x,y]
+ */
+STATIC EFI_STATUS path_begin(GFX_PATH *Path, INT64 x, INT64 y)
+{
+    if (!check_path_point(x, y)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    if (Path->NumContours == Path->MaxContours) {
+        UINTN Max = Path->MaxContours ? Path->MaxContours * 2 : 8;
+        UINT32 *Contours = ReallocatePool(Path->MaxContours * sizeof(UINT32), Max * sizeof(UINT32), Path->Contours);
+        if (!Contours) {
+            DbgPrint(DL_ERROR, "%a(), memory allocation error => EFI_OUT_OF_RESOURCES\n", __func__);
+            return EFI_OUT_OF_RESOURCES;
+        }
+        Path->Contours = Contours;
+        Path->MaxContours = Max;
+    }
+    // a lone move to is replaced
+    if (Path->NumContours && !(Path->Contours[Path->NumContours - 1] & PATH_CLOSED)) {
+        UINTN Start = (Path->NumContours > 1) ? (Path->Contours[Path->NumContours - 2] & ~PATH_CLOSED) : 0;
+        if (Path->NumPoints - Start == 1) {
+            Path->NumPoints--;
+            Path->NumContours--;
+        }
+    }
+    Path->Contours[Path->NumContours++] = (UINT32)Path->NumPoints;
+    return path_add_point(Path, x, y);
+}
+
+/*
+ * path_add_point() - append point to current contour
+ */
+STATIC EFI_STATUS path_add_point(GFX_PATH *Path, INT64 x, INT64 y)
+{
+    if (!check_path_point(x, y)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    if (Path->NumPoints == Path->MaxPoints) {
+        UINTN Max = Path->MaxPoints ? Path->MaxPoints * 2 : 64;
+        if (Max >= PATH_CLOSED) {
+            return EFI_OUT_OF_RESOURCES;
+        }
+        POINT *Points = ReallocatePool(Path->MaxPoints * sizeof(POINT), Max * sizeof(POINT), Path->Points);
+        if (!Points) {
+            DbgPrint(DL_ERROR, "%a(), memory allocation error => EFI_OUT_OF_RESOURCES\n", __func__);
+            return EFI_OUT_OF_RESOURCES;
+        }
+        Path->Points = Points;
+        Path->MaxPoints = Max;
+    }
+    Path->Points[Path->NumPoints].X = (INT32)x;
+    Path->Points[Path->NumPoints].Y = (INT32)y;
+    Path->NumPoints++;
+    Path->Contours[Path->NumContours - 1] = (UINT32)Path->NumPoints;
+    return EFI_SUCCESS;
+}
+
+/*
+ * flatten_quad() - split quadratic Bezier in half until it is within PATH_TOLERANCE of a line
+ *
+ * The curve strays at most |p0 - 2p1 + p2| / 4 from its chord.
+ */
+STATIC EFI_STATUS flatten_quad(GFX_PATH *Path, INT64 x0, INT64 y0, INT64 x1, INT64 y1, INT64 x2, INT64 y2, UINTN Depth)
+{
+    INT64 ddx = x0 - 2 * x1 + x2;
+    INT64 ddy = y0 - 2 * y1 + y2;
+    if (Depth >= PATH_MAX_DEPTH || MAX(ABS(ddx), ABS(ddy)) <= 4 * PATH_TOLERANCE) {
+        return path_add_point(Path, x2, y2);
+    }
+    INT64 ax = ARShiftU64(x0 + x1, 1);
+    INT64 ay = ARShiftU64(y0 + y1, 1);
+    INT64 bx = ARShiftU64(x1 + x2, 1);
+    INT64 by = ARShiftU64(y1 + y2, 1);
+    INT64 mx = ARShiftU64(ax + bx, 1);
+    INT64 my = ARShiftU64(ay + by, 1);
+    EFI_STATUS Status = flatten_quad(Path, x0, y0, ax, ay, mx, my, Depth + 1);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    return flatten_quad(Path, mx, my, bx, by, x2, y2, Depth + 1);
+}
+
+/*
+ * flatten_cubic() - split cubic Bezier in half until it is within PATH_TOLERANCE of a line
+ *
+ * The curve strays at most 3/4 of the larger second difference from its chord.
+ */
+STATIC EFI_STATUS flatten_cubic(GFX_PATH *Path, INT64 x0, INT64 y0, INT64 x1, INT64 y1, INT64 x2, INT64 y2, INT64 x3, INT64 y3, UINTN Depth)
+{
+    INT64 d1 = MAX(ABS(x0 - 2 * x1 + x2), ABS(y0 - 2 * y1 + y2));
+    INT64 d2 = MAX(ABS(x1 - 2 * x2 + x3), ABS(y1 - 2 * y2 + y3));
+    if (Depth >= PATH_MAX_DEPTH || 3 * MAX(d1, d2) <= 4 * PATH_TOLERANCE) {
+        return path_add_point(Path, x3, y3);
+    }
+    INT64 ax = ARShiftU64(x0 + x1, 1);
+    INT64 ay = ARShiftU64(y0 + y1, 1);
+    INT64 bx = ARShiftU64(x1 + x2, 1);
+    INT64 by = ARShiftU64(y1 + y2, 1);
+    INT64 cx = ARShiftU64(x2 + x3, 1);
+    INT64 cy = ARShiftU64(y2 + y3, 1);
+    INT64 abx = ARShiftU64(ax + bx, 1);
+    INT64 aby = ARShiftU64(ay + by, 1);
+    INT64 bcx = ARShiftU64(bx + cx, 1);
+    INT64 bcy = ARShiftU64(by + cy, 1);
+    INT64 mx = ARShiftU64(abx + bcx, 1);
+    INT64 my = ARShiftU64(aby + bcy, 1);
+    EFI_STATUS Status = flatten_cubic(Path, x0, y0, ax, ay, abx, aby, mx, my, Depth + 1);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    return flatten_cubic(Path, mx, my, bcx, bcy, cx, cy, x3, y3, Depth + 1);
+}
+
+EFI_STATUS DrawFillPath(CONST GFX_PATH *Path, FILL_RULE Rule, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Path=0x%p, Rule=%u, colour=0x%08X)\n", __func__, Path, Rule, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_path(&gCurrCtx, Path, FALSE, 0, Rule, colour, NULL);
+}
+
+EFI_STATUS DrawStrokePath(CONST GFX_PATH *Path, INT32 Width, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Path=0x%p, Width=0x%X, colour=0x%08X)\n", __func__, Path, Width, colour);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_path(&gCurrCtx, Path, TRUE, Width, FILL_NON_ZERO, colour, NULL);
+}
+
+EFI_STATUS CtxDrawFillPath(GFX_CONTEXT *Ctx, CONST GFX_PATH *Path, FILL_RULE Rule, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Path=0x%p, Rule=%u, colour=0x%08X)\n", __func__, Ctx, Path, Rule, colour);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_path(Ctx, Path, FALSE, 0, Rule, colour, NULL);
+}
+
+EFI_STATUS CtxDrawStrokePath(GFX_CONTEXT *Ctx, CONST GFX_PATH *Path, INT32 Width, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Path=0x%p, Width=0x%X, colour=0x%08X)\n", __func__, Ctx, Path, Width, colour);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_path(Ctx, Path, TRUE, Width, FILL_NON_ZERO, colour, NULL);
+}
+
+EFI_STATUS DrawGradientPath(CONST GFX_PATH *Path, FILL_RULE Rule, CONST GRADIENT *Gradient)
+{
+    DbgPrint(DL_INFO, "%a(Path=0x%p, Rule=%u, Gradient=0x%p)\n", __func__, Path, Rule, Gradient);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    return draw_gradient_path(&gCurrCtx, Path, Rule, Gradient);
+}
+
+EFI_STATUS CtxDrawGradientPath(GFX_CONTEXT *Ctx, CONST GFX_PATH *Path, FILL_RULE Rule, CONST GRADIENT *Gradient)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Path=0x%p, Rule=%u, Gradient=0x%p)\n", __func__, Ctx, Path, Rule, Gradient);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return draw_gradient_path(Ctx, Path, Rule, Gradient);
+}
+
+/*
+ * draw_gradient_path() - fill path with gradient
+ */
+STATIC EFI_STATUS draw_gradient_path(GFX_CONTEXT *Ctx, CONST GFX_PATH *Path, FILL_RULE Rule, CONST GRADIENT *Gradient)
+{
+    GRADIENT_PAINT Paint;
+    EFI_STATUS Status = init_gradient(&Paint, Gradient);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    return draw_path(Ctx, Path, FALSE, 0, Rule, 0, &Paint);
+}
+
+/*
+ * draw_path() - accumulate path (filled or stroked) into coverage over its bounds then blend colour, or Paint's colours
+ *
+ * The bounds are covered in bands of PATH_BAND_ROWS rows sharing one strip, each band
+ * walks the whole path and lines outside it are dropped by coverage_line().
+ */
+STATIC EFI_STATUS draw_path(GFX_CONTEXT *Ctx, CONST GFX_PATH *Path, BOOLEAN Stroke, INT32 Width, FILL_RULE Rule, UINT32 colour, CONST GRADIENT_PAINT *Paint)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Path=0x%p, Stroke=%u, Width=0x%X, Rule=%u, colour=0x%08X)\n", __func__, Ctx, Path, Stroke, Width, Rule, colour);
+
+    if (!check_path(Path) || Rule >= NUM_FILL_RULES || Width < 0 || Width > PATH_MAX_ORD) {
+        return EFI_INVALID_PARAMETER;
+    }
+    if (Path->NumPoints == 0) {
+        return EFI_SUCCESS;
+    }
+    // pixel bounds of path (widened by stroke) within clip window
+    INT64 HalfWidth = Width / 2;
+    INT64 MinX = MAX_INT64;
+    INT64 MinY = MAX_INT64;
+    INT64 MaxX = -MAX_INT64;
+    INT64 MaxY = -MAX_INT64;
+    for (UINTN i = 0; i < Path->NumPoints; i++) {
+        // points are range checked as they are added, but the path is caller's memory
+        if (!check_path_point(Path->Points[i].X, Path->Points[i].Y)) {
+            return EFI_INVALID_PARAMETER;
+        }
+        MinX = MIN(MinX, Path->Points[i].X);
+        MinY = MIN(MinY, Path->Points[i].Y);
+        MaxX = MAX(MaxX, Path->Points[i].X);
+        MaxY = MAX(MaxY, Path->Points[i].Y);
+    }
+    INT64 x0 = ARShiftU64(MinX - HalfWidth, 16);
+    INT64 y0 = ARShiftU64(MinY - HalfWidth, 16);
+    INT64 x1 = ARShiftU64(MaxX + HalfWidth, 16);
+    INT64 y1 = ARShiftU64(MaxY + HalfWidth, 16);
+    x0 = MAX(x0, Ctx->ClipX0);
+    y0 = MAX(y0, Ctx->ClipY0);
+    x1 = MIN(x1, Ctx->ClipX1);
+    y1 = MIN(y1, Ctx->ClipY1);
+    if (x0 > x1 || y0 > y1) {
+        return EFI_SUCCESS;
+    }
+    COVERAGE Cov;
+    Cov.X0 = (INT32)x0;
+    Cov.Width = (INT32)(x1 - x0 + 1);
+    Cov.Acc = AllocatePool((UINTN)(Cov.Width + 2) * MIN(y1 - y0 + 1, PATH_BAND_ROWS) * sizeof(INT32));
+    UINT32 *RowColours = Paint ? AllocatePool((UINTN)Cov.Width * sizeof(UINT32)) : NULL;
+    if (!Cov.Acc || (Paint && !RowColours)) {
+        DbgPrint(DL_ERROR, "%a(), memory allocation error => EFI_OUT_OF_RESOURCES\n", __func__);
+        if (Cov.Acc) {
+            FreePool(Cov.Acc);
+        }
+        if (RowColours) {
+            FreePool(RowColours);
+        }
+        return EFI_OUT_OF_RESOURCES;
+    }
+
+    EDK2SIM_GFX_BEGIN;
+    for (INT64 Band = y0; Band <= y1; Band += PATH_BAND_ROWS) {
+        Cov.Y0 = (INT32)Band;
+        Cov.Height = (INT32)MIN(y1 - Band + 1, PATH_BAND_ROWS);
+        ZeroMem(Cov.Acc, (UINTN)(Cov.Width + 2) * Cov.Height * sizeof(INT32));
+        if (Stroke) {
+            stroke_path(&Cov, Path, HalfWidth);
+        } else {
+            fill_path(&Cov, Path);
+        }
+        composite_coverage(Ctx, &Cov, Rule, colour, Paint, RowColours);
+    }
+    EDK2SIM_GFX_END;
 
-        if (d > 0) {
-            y--;
-            ptr_br -= gCurrRenBuf->PixPerScnLn;
-            ptr_bl -= gCurrRenBuf->PixPerScnLn;
-            ptr_tr += gCurrRenBuf->PixPerScnLn;
-            ptr_tl += gCurrRenBuf->PixPerScnLn;
-            ptr_rd--;
-            ptr_ld++;
-            ptr_ru--;
-            ptr_lu++;
+    FreePool(Cov.Acc);
+    if (RowColours) {
+        FreePool(RowColours);
+    }
+    return EFI_SUCCESS;
+}
 
-            d = d + 4 * (x - y) + 10;
+/*
+ * fill_path() - accumulate every contour of the path, each closed for filling
+ */
+STATIC VOID fill_path(COVERAGE *Cov, CONST GFX_PATH *Path)
+{
+    UINTN Start = 0;
+
+    for (UINTN c = 0; c < Path->NumContours; c++) {
+        UINTN End = Path->Contours[c] & ~PATH_CLOSED;
+        for (UINTN i = Start; i < End; i++) {
+            CONST POINT *A = &Path->Points[i];
+            CONST POINT *B = &Path->Points[(i + 1 < End) ? i + 1 : Start];
+            coverage_line(Cov, A->X, A->Y, B->X, B->Y);
+        }
+        Start = End;
+    }
+}
+
+/*
+ * stroke_path() - accumulate a quad per segment plus bevel joins, all wound the same way so overlaps add
+ */
+STATIC VOID stroke_path(COVERAGE *Cov, CONST GFX_PATH *Path, INT64 HalfWidth)
+{
+    UINTN Start = 0;
+
+    for (UINTN c = 0; c < Path->NumContours; c++) {
+        UINTN End = Path->Contours[c] & ~PATH_CLOSED;
+        BOOLEAN Closed = (Path->Contours[c] & PATH_CLOSED) && (End - Start > 2);
+        UINTN NumSegs = Closed ? End - Start : End - Start - 1;
+        INT64 PrevNx = 0;
+        INT64 PrevNy = 0;
+        INT64 FirstNx = 0;
+        INT64 FirstNy = 0;
+        BOOLEAN HavePrev = FALSE;
+        for (UINTN s = 0; s < NumSegs; s++) {
+            CONST POINT *A = &Path->Points[Start + s];
+            CONST POINT *B = &Path->Points[(Start + s + 1 < End) ? Start + s + 1 : Start];
+            INT64 dx = (INT64)B->X - A->X;
+            INT64 dy = (INT64)B->Y - A->Y;
+            INT64 Len = (INT64)isqrt64((UINT64)(dx * dx + dy * dy));
+            if (Len == 0) {
+                continue;
+            }
+            INT64 Nx = DivS64x64Remainder(-dy * HalfWidth, Len, NULL);
+            INT64 Ny = DivS64x64Remainder(dx * HalfWidth, Len, NULL);
+            INT64 X[4] = { A->X + Nx, B->X + Nx, B->X - Nx, A->X - Nx };
+            INT64 Y[4] = { A->Y + Ny, B->Y + Ny, B->Y - Ny, A->Y - Ny };
+            coverage_polygon(Cov, X, Y, 4);
+            if (HavePrev) {
+                // bevel on both sides, the inner one is already covered
+                INT64 JX[3] = { A->X, A->X + PrevNx, A->X + Nx };
+                INT64 JY[3] = { A->Y, A->Y + PrevNy, A->Y + Ny };
+                coverage_polygon(Cov, JX, JY, 3);
+                INT64 KX[3] = { A->X, A->X - PrevNx, A->X - Nx };
+                INT64 KY[3] = { A->Y, A->Y - PrevNy, A->Y - Ny };
+                coverage_polygon(Cov, KX, KY, 3);
+            } else {
+                FirstNx = Nx;
+                FirstNy = Ny;
+            }
+            PrevNx = Nx;
+            PrevNy = Ny;
+            HavePrev = TRUE;
+        }
+        if (Closed && HavePrev) {
+            CONST POINT *A = &Path->Points[Start];
+            INT64 JX[3] = { A->X, A->X + PrevNx, A->X + FirstNx };
+            INT64 JY[3] = { A->Y, A->Y + PrevNy, A->Y + FirstNy };
+            coverage_polygon(Cov, JX, JY, 3);
+            INT64 KX[3] = { A->X, A->X - PrevNx, A->X - FirstNx };
+            INT64 KY[3] = { A->Y, A->Y - PrevNy, A->Y - FirstNy };
+            coverage_polygon(Cov, KX, KY, 3);
+        }
+        Start = End;
+    }
+}
+
+/*
+ * coverage_polygon() - accumulate closed polygon wound anticlockwise on screen (negative coverage)
+ */
+STATIC VOID coverage_polygon(COVERAGE *Cov, CONST INT64 *X, CONST INT64 *Y, UINTN Count)
+{
+    INT64 Area = 0;
+    for (UINTN i = 0; i < Count; i++) {
+        UINTN j = (i + 1 < Count) ? i + 1 : 0;
+        Area += ARShiftU64(X[i] * Y[j] - X[j] * Y[i], 16);
+    }
+    for (UINTN i = 0; i < Count; i++) {
+        UINTN j = (i + 1 < Count) ? i + 1 : 0;
+        if (Area > 0) {
+            coverage_line(Cov, X[j], Y[j], X[i], Y[i]);
         } else {
-            d = d + 4 * x + 6;
+            coverage_line(Cov, X[i], Y[i], X[j], Y[j]);
+        }
+    }
+}
+
+/*
+ * coverage_line() - accumulate signed area to the right of line [x0,y0] -> [x1,y1] (16.16)
+ *
+ * Parts of the line left or right of the buffer are moved onto its edge, where
+ * they still add (or, to the right, harmlessly add nothing visible) coverage.
+ */
+STATIC VOID coverage_line(COVERAGE *Cov, INT64 x0, INT64 y0, INT64 x1, INT64 y1)
+{
+    x0 -= (INT64)Cov->X0 * COVERAGE_ONE;
+    x1 -= (INT64)Cov->X0 * COVERAGE_ONE;
+    y0 -= (INT64)Cov->Y0 * COVERAGE_ONE;
+    y1 -= (INT64)Cov->Y0 * COVERAGE_ONE;
+    if (y0 == y1) {
+        return;
+    }
+    INT64 Bottom = (INT64)Cov->Height * COVERAGE_ONE;
+    if ((y0 <= 0 && y1 <= 0) || (y0 >= Bottom && y1 >= Bottom)) {
+        return;
+    }
+    // split at buffer's left and right edges
+    INT64 Edge[2] = { 0, (INT64)Cov->Width * COVERAGE_ONE };
+    for (UINTN e = 0; e < 2; e++) {
+        if ((x0 < Edge[e]) != (x1 < Edge[e]) && x0 != Edge[e] && x1 != Edge[e]) {
+            INT64 ys = y0 + DivS64x64Remainder((y1 - y0) * (Edge[e] - x0), x1 - x0, NULL);
+            INT64 Origin[2] = { (INT64)Cov->X0 * COVERAGE_ONE, (INT64)Cov->Y0 * COVERAGE_ONE };
+            coverage_line(Cov, x0 + Origin[0], y0 + Origin[1], Edge[e] + Origin[0], ys + Origin[1]);
+            coverage_line(Cov, Edge[e] + Origin[0], ys + Origin[1], x1 + Origin[0], y1 + Origin[1]);
+            return;
         }
-        
-        *ptr_br = colour;   // (xc + x, yc + y)
-        *ptr_bl = colour;   // (xc - x, yc + y)
-        *ptr_tr = colour;   // (xc + x, yc - y)
-        *ptr_tl = colour;   // (xc - x, yc - y)
-        *ptr_rd = colour;   // (xc + y, yc + x)
-        *ptr_ld = colour;   // (xc - y, yc + x)
-        *ptr_ru = colour;   // (xc + y, yc - x)
-        *ptr_lu = colour;   // (xc - y, yc - x)
     }
-    EDK2SIM_GFX_END;
+    x0 = (x0 < 0) ? 0 : (x0 > Edge[1]) ? Edge[1] : x0;
+    x1 = (x1 < 0) ? 0 : (x1 > Edge[1]) ? Edge[1] : x1;
 
-    return TRUE;
+    INT64 Dir = 1;
+    if (y0 > y1) {
+        SWAP(INT64, x0, x1);
+        SWAP(INT64, y0, y1);
+        Dir = -1;
+    }
+    INT64 Dx = x1 - x0;
+    INT64 Dy = y1 - y0;
+    INT32 RowStart = (INT32)((y0 < 0) ? 0 : ARShiftU64(y0, 16));
+    INT32 RowEnd = (INT32)((y1 > Bottom) ? Cov->Height : ARShiftU64(y1 + COVERAGE_ONE - 1, 16));
+    for (INT32 Row = RowStart; Row < RowEnd; Row++) {
+        INT64 ya = MAX((INT64)Row * COVERAGE_ONE, y0);
+        INT64 yb = MIN((INT64)(Row + 1) * COVERAGE_ONE, y1);
+        INT64 xa = x0 + DivS64x64Remainder(Dx * (ya - y0), Dy, NULL);
+        INT64 xb = x0 + DivS64x64Remainder(Dx * (yb - y0), Dy, NULL);
+        coverage_row(Cov->Acc + (UINTN)Row * (Cov->Width + 2), xa, xb, (yb - ya) * Dir);
+    }
 }
-#endif
 
-VOID DrawFillCircle(INT32 xc, INT32 yc, INT32 r, UINT32 colour)
+/*
+ * coverage_row() - add line crossing one row from xa to xb with height d to its cells
+ *
+ * Each cell gets the change in coverage from the cell before, the part of d
+ * left of the line in it plus the part right of the line in the cell before,
+ * so the cells always add up to d.
+ */
+STATIC VOID coverage_row(INT32 *Acc, INT64 xa, INT64 xb, INT64 d)
 {
-    DbgPrint(DL_INFO, "%a(xc=%d, yc=%d, r=%d, colour=0x%08X)\n", __func__, xc, yc, r, colour);
-
-    if (!Initialised) {
-        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => 0\n", __func__);
+    if (xa > xb) {
+        SWAP(INT64, xa, xb);
+    }
+    INT64 x0i = ARShiftU64(xa, 16);
+    INT64 x1c = ARShiftU64(xb + COVERAGE_ONE - 1, 16);
+    if (x1c <= x0i + 1) {
+        // within one pixel, split by mean x
+        INT64 xm = ARShiftU64(xa + xb, 1) - x0i * COVERAGE_ONE;
+        INT64 a = ARShiftU64(d * xm, 16);
+        Acc[x0i] += (INT32)(d - a);
+        Acc[x0i + 1] += (INT32)a;
         return;
     }
-    INT32 x = 0;
-    INT32 y = r;
-    INT32 d = 3 - 2 * r;
+    // S is coverage added per pixel of x travelled
+    INT64 S = DivS64x64Remainder(d * COVERAGE_ONE, xb - xa, NULL);
+    INT64 f0 = COVERAGE_ONE - (xa - x0i * COVERAGE_ONE);
+    INT64 f1 = xb - (x1c - 1) * COVERAGE_ONE;
+    INT64 a0 = ARShiftU64(S * ARShiftU64(f0 * f0, 16), 17);
+    INT64 am = ARShiftU64(S * ARShiftU64(f1 * f1, 16), 17);
+    Acc[x0i] += (INT32)a0;
+    if (x1c == x0i + 2) {
+        Acc[x0i + 1] += (INT32)(d - a0 - am);
+    } else {
+        INT64 a1 = ARShiftU64(S * (f0 + (COVERAGE_ONE >> 1)), 16);
+        Acc[x0i + 1] += (INT32)(a1 - a0);
+        for (INT64 x = x0i + 2; x < x1c - 1; x++) {
+            Acc[x] += (INT32)S;
+        }
+        INT64 a2 = a1 + S * (x1c - x0i - 3);
+        Acc[x1c - 1] += (INT32)(d - a2 - am);
+    }
+    Acc[x1c] += (INT32)am;
+}
 
-    EDK2SIM_GFX_BEGIN;
-    while (y >= x) {
-        draw_hline(xc - x, yc + y, x * 2 + 1, colour); // bottom
-        draw_hline(xc - x, yc - y, x * 2 + 1, colour); // top
-        draw_hline(xc - y, yc + x, y * 2 + 1, colour); // mid-bottom
-        draw_hline(xc - y, yc - x, y * 2 + 1, colour); // mid-top
-        x++;
+/*
+ * composite_coverage() - blend colour into clip window by coverage, in one pass over the rows
+ *
+ * With Paint each row's colours are generated into RowColours first.
+ */
+STATIC VOID composite_coverage(GFX_CONTEXT *Ctx, CONST COVERAGE *Cov, FILL_RULE Rule, UINT32 colour, CONST GRADIENT_PAINT *Paint, UINT32 *RowColours)
+{
+    UINT32 *ptr = Ctx->RenBuf->PixelData + Cov->X0 + (Cov->Y0 * Ctx->RenBuf->PixPerScnLn);
+    CONST INT32 *Acc = Cov->Acc;
 
-        if (d > 0) {
-            y--;
-            d = d + 4 * (x - y) + 10;
+    for (INT32 y = 0; y < Cov->Height; y++) {
+        INT32 Sum = 0;
+        if (Paint) {
+            gradient_row(Paint, Cov->X0, Cov->X0 + Cov->Width - 1, Cov->Y0 + y, RowColours);
+        }
+        for (INT32 x = 0; x < Cov->Width; x++) {
+            Sum += Acc[x];
+            UINT32 c = (UINT32)ABS(Sum);
+            if (Rule == FILL_EVEN_ODD) {
+                c &= (2 * COVERAGE_ONE) - 1;
+                if (c > COVERAGE_ONE) {
+                    c = (2 * COVERAGE_ONE) - c;
+                }
+            } else if (c > COVERAGE_ONE) {
+                c = COVERAGE_ONE;
+            }
+            // 0..256
+            c = (c + 128) >> 8;
+            if (Paint) {
+                colour = RowColours[x];
+            }
+            if (c >= 256) {
+                ptr[x] = colour;
+            } else if (c) {
+                ptr[x] = lerp_colour(ptr[x], colour, c);
+            }
+        }
+        Acc += Cov->Width + 2;
+        ptr += Ctx->RenBuf->PixPerScnLn;
+    }
+}
+
+/*
+ * isqrt64() - floor(sqrt(n))
+ */
+STATIC UINT64 isqrt64(UINT64 n)
+{
+    UINT64 Root = 0;
+    UINT64 Bit = (UINT64)1 << 62;
+
+    while (Bit > n) {
+        Bit >>= 2;
+    }
+    while (Bit) {
+        if (n >= Root + Bit) {
+            n -= Root + Bit;
+            Root = (Root >> 1) + Bit;
         } else {
-            d = d + 4 * x + 6;
+            Root >>= 1;
         }
+        Bit >>= 2;
     }
-    EDK2SIM_GFX_END;
+    return Root;
 }
 
 STATIC CONST UINT8 *get_font_data(FONT Font)
@@ -1431,7 +7101,32 @@ UINTN EFIAPI GPrint(CHAR16 *sFormat, ...)
     VA_START(vl, sFormat);
     UINTN Length = UnicodeVSPrint(String, STRING_SIZE, sFormat, vl);
     VA_END(vl);
-    EFI_STATUS Status = put_string(gCurrRenBuf, NULL, String);
+    EFI_STATUS Status = put_string(gCurrCtx.RenBuf, NULL, String);
+    if (EFI_ERROR(Status)) {
+        DbgPrint(DL_INFO, "%a(), put_string() => %a => 0\n", __func__, EFIStatusToStr(Status));
+        return 0;
+    }
+
+    return Length;
+}
+
+UINTN EFIAPI CtxGPrint(GFX_CONTEXT *Ctx, CHAR16 *sFormat, ...)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, sFormat=0x%p ...)\n", __func__, Ctx, sFormat);
+
+    if (!check_context(Ctx)) {
+        return 0;
+    }
+    if (!sFormat) {
+        DbgPrint(DL_WARN, "%a(), sFormat=NULL => 0\n", __func__);
+        return 0;
+    }
+    CHAR16 String[STRING_SIZE];
+    VA_LIST vl;
+    VA_START(vl, sFormat);
+    UINTN Length = UnicodeVSPrint(String, STRING_SIZE, sFormat, vl);
+    VA_END(vl);
+    EFI_STATUS Status = put_string(Ctx->RenBuf, &Ctx->TxtCfg, String);
     if (EFI_ERROR(Status)) {
         DbgPrint(DL_INFO, "%a(), put_string() => %a => 0\n", __func__, EFIStatusToStr(Status));
         return 0;
@@ -1479,10 +7174,46 @@ EFI_STATUS EFIAPI GPutString(INT32 x, INT32 y, UINT32 FgColour, UINT32 BgColour,
         return EFI_NOT_READY;
     }
     TEXT_CONFIG TxtCfg = {
-        .X0 = gCurrRenBuf->ClipX0,
-        .Y0 = gCurrRenBuf->ClipY0,
-        .X1 = gCurrRenBuf->ClipX1,
-        .Y1 = gCurrRenBuf->ClipY1,
+        .X0 = gCurrCtx.ClipX0,
+        .Y0 = gCurrCtx.ClipY0,
+        .X1 = gCurrCtx.ClipX1,
+        .Y1 = gCurrCtx.ClipY1,
+        .Font = Font,
+        .FontData = get_font_data(Font),
+        .CurrX = x,
+        .CurrY = y,  
+        .FgColour = FgColour,
+        .BgColour = BgColour,
+        .BgColourEnabled = BgColourEnabled,
+        .LineWrapEnabled = FALSE,
+        .ScrollEnabled = FALSE
+    };
+    CHAR16 String[STRING_SIZE];
+    VA_LIST vl;
+    VA_START(vl, sFormat);
+    UnicodeVSPrint(String, STRING_SIZE, sFormat, vl);
+    VA_END(vl);
+    EFI_STATUS Status = put_string(gCurrCtx.RenBuf, &TxtCfg, String);
+    if (EFI_ERROR(Status)) {
+        DbgPrint(DL_WARN, "%a(), put_string() => %a\n", __func__, EFIStatusToStr(Status));
+        return Status;
+    }
+
+    return EFI_SUCCESS;
+}
+
+EFI_STATUS EFIAPI CtxGPutString(GFX_CONTEXT *Ctx, INT32 x, INT32 y, UINT32 FgColour, UINT32 BgColour, BOOLEAN BgColourEnabled, FONT Font, CHAR16 *sFormat, ...)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, x=%d, y=%d, FgColour=0x%08X, BgColour=0x%08X, BgColourEnabled=%u, Font=%u, sFormat=0x%p)\n", __func__, Ctx, x, y, FgColour, BgColour, BgColourEnabled, Font, sFormat);
+
+    if (!check_context(Ctx)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    TEXT_CONFIG TxtCfg = {
+        .X0 = Ctx->ClipX0,
+        .Y0 = Ctx->ClipY0,
+        .X1 = Ctx->ClipX1,
+        .Y1 = Ctx->ClipY1,
         .Font = Font,
         .FontData = get_font_data(Font),
         .CurrX = x,
@@ -1498,7 +7229,7 @@ EFI_STATUS EFIAPI GPutString(INT32 x, INT32 y, UINT32 FgColour, UINT32 BgColour,
     VA_START(vl, sFormat);
     UnicodeVSPrint(String, STRING_SIZE, sFormat, vl);
     VA_END(vl);
-    EFI_STATUS Status = put_string(gCurrRenBuf, &TxtCfg, String);
+    EFI_STATUS Status = put_string(Ctx->RenBuf, &TxtCfg, String);
     if (EFI_ERROR(Status)) {
         DbgPrint(DL_WARN, "%a(), put_string() => %a\n", __func__, EFIStatusToStr(Status));
         return Status;
@@ -1684,7 +7415,17 @@ VOID EnableTextBackground(BOOLEAN State)
         DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised\n", __func__);
         return;
     }
-    gCurrRenBuf->TxtCfg.BgColourEnabled = State;
+    gCurrCtx.RenBuf->TxtCfg.BgColourEnabled = State;
+}
+
+VOID CtxEnableTextBackground(GFX_CONTEXT *Ctx, BOOLEAN State)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, State=%u)\n", __func__, Ctx, State);
+
+    if (!check_context(Ctx)) {
+        return;
+    }
+    Ctx->TxtCfg.BgColourEnabled = State;
 }
 
 VOID EnableTextBoxBackground(TEXT_BOX *TxtBox, BOOLEAN State)
@@ -1710,7 +7451,17 @@ VOID SetTextForeground(UINT32 colour)
         DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised\n", __func__);
         return;
     }
-    gCurrRenBuf->TxtCfg.FgColour = colour;
+    gCurrCtx.RenBuf->TxtCfg.FgColour = colour;
+}
+
+VOID CtxSetTextForeground(GFX_CONTEXT *Ctx, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, colour=0x%08X)\n", __func__, Ctx, colour);
+
+    if (!check_context(Ctx)) {
+        return;
+    }
+    Ctx->TxtCfg.FgColour = colour;
 }
 
 VOID SetTextBoxForeground(TEXT_BOX *TxtBox, UINT32 colour)
@@ -1736,7 +7487,17 @@ VOID SetTextBackground(UINT32 colour)
         DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised\n", __func__);
         return;
     }
-    gCurrRenBuf->TxtCfg.BgColour = colour;
+    gCurrCtx.RenBuf->TxtCfg.BgColour = colour;
+}
+
+VOID CtxSetTextBackground(GFX_CONTEXT *Ctx, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, colour=0x%08X)\n", __func__, Ctx, colour);
+
+    if (!check_context(Ctx)) {
+        return;
+    }
+    Ctx->TxtCfg.BgColour = colour;
 }
 
 VOID SetTextBoxBackground(TEXT_BOX *TxtBox, UINT32 colour)
@@ -1762,8 +7523,19 @@ VOID SetFont(FONT font)
         DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised\n", __func__);
         return;
     }
-    gCurrRenBuf->TxtCfg.Font = font;
-    gCurrRenBuf->TxtCfg.FontData = get_font_data(font);
+    gCurrCtx.RenBuf->TxtCfg.Font = font;
+    gCurrCtx.RenBuf->TxtCfg.FontData = get_font_data(font);
+}
+
+VOID CtxSetFont(GFX_CONTEXT *Ctx, FONT font)
+{
+    DbgPrint(DL_INFO, "%a(Ctx=0x%p, Font=%u)\n", __func__, Ctx, font);
+
+    if (!check_context(Ctx)) {
+        return;
+    }
+    Ctx->TxtCfg.Font = font;
+    Ctx->TxtCfg.FontData = get_font_data(font);
 }
 
 CONST CHAR8 *GetFontName(FONT Font)
@@ -1906,6 +7678,405 @@ EFI_STATUS ClearTextBox(TEXT_BOX *TxtBox)
     return EFI_SUCCESS;
 }
 
+//-------------------------------------------------------------------------
+// JOB SCHEDULER
+//
+// Each core owns a fixed size deque of jobs. The owner pops from the
+// bottom while idle cores steal from the top of other cores deques, so
+// cores that finish their own (cheap) jobs early take work from those
+// that are still busy. Jobs are queued with SubmitJob() and executed by
+// all cores when WaitForJobs() is called. A job may not queue or wait for
+// other jobs, those calls return EFI_ACCESS_DENIED while jobs are running.
+//-------------------------------------------------------------------------
+
+#define MAX_JOB_CORES       64
+#define JOB_QUEUE_SIZE      256     // jobs per core (must be a power of 2)
+#define JOB_QUEUE_MASK      (JOB_QUEUE_SIZE - 1)
+
+typedef struct {
+    JOB_PROC    Proc;
+    VOID        *Arg;
+} JOB;
+
+typedef struct {
+    volatile UINT32 Top;        // next job to steal
+    volatile UINT32 Bottom;     // next free slot (owner)
+    JOB             Jobs[JOB_QUEUE_SIZE];
+    UINT64          BusyTicks;
+    UINT64          IdleTicks;
+    UINT32          JobsRun;
+    UINT32          JobsStolen;
+} JOB_QUEUE;
+
+STATIC BOOLEAN                      gJobsInitialised = FALSE;
+STATIC EFI_MP_SERVICES_PROTOCOL     *gMpServices = NULL;
+STATIC EFI_EVENT                    gJobEvent = NULL;
+STATIC UINTN                        gNumJobCores = 1;               // cores taking part (including BSP)
+STATIC UINTN                        gJobCoreProc[MAX_JOB_CORES];    // core -> processor number
+STATIC JOB_QUEUE                    gJobQueue[MAX_JOB_CORES];
+STATIC volatile UINT32              gJobsPending = 0;
+STATIC BOOLEAN                      gJobsRunning = FALSE;           // inside WaitForJobs()
+STATIC UINTN                        gNextJobCore = 0;
+
+EFI_STATUS InitJobScheduler(UINTN MaxCores)
+{
+    DbgPrint(DL_INFO, "%a(MaxCores=%u)\n", __func__, MaxCores);
+
+    if (!Initialised) {
+        DbgPrint(DL_ERROR, "%a(), GraphicsLib not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    if (gJobsRunning) {
+        DbgPrint(DL_ERROR, "%a(), called from a job => EFI_ACCESS_DENIED\n", __func__);
+        return EFI_ACCESS_DENIED;
+    }
+    if (gJobsInitialised) {
+        ShutdownJobScheduler();
+    }
+    if (MaxCores == 0 || MaxCores > MAX_JOB_CORES) {
+        MaxCores = MAX_JOB_CORES;
+    }
+    ZeroMem(gJobQueue, sizeof(gJobQueue));
+    gJobsPending = 0;
+    gNextJobCore = 0;
+    gNumJobCores = 1;
+    gJobCoreProc[0] = 0;
+    gMpServices = NULL;
+
+#if JOB_SCHEDULER
+    EFI_MP_SERVICES_PROTOCOL *MpServices;
+    EFI_STATUS Status = gBS->LocateProtocol(&gEfiMpServiceProtocolGuid, NULL, (VOID **)&MpServices);
+    if (!EFI_ERROR(Status)) {
+        UINTN BspNum;
+        UINTN NumProcs;
+        UINTN NumEnabled;
+        Status = MpServices->WhoAmI(MpServices, &BspNum);
+        if (!EFI_ERROR(Status)) {
+            Status = MpServices->GetNumberOfProcessors(MpServices, &NumProcs, &NumEnabled);
+        }
+        if (!EFI_ERROR(Status)) {
+            Status = gBS->CreateEvent(0, TPL_NOTIFY, NULL, NULL, &gJobEvent);
+        }
+        if (!EFI_ERROR(Status)) {
+            // BSP is always core 0, then enabled APs
+            gJobCoreProc[0] = BspNum;
+            for (UINTN i = 0; i < NumProcs && gNumJobCores < MaxCores; i++) {
+                EFI_PROCESSOR_INFORMATION Info;
+                if (i == BspNum || EFI_ERROR(MpServices->GetProcessorInfo(MpServices, i, &Info))) {
+                    continue;
+                }
+                if (Info.StatusFlag & PROCESSOR_ENABLED_BIT) {
+                    gJobCoreProc[gNumJobCores++] = i;
+                }
+            }
+            gMpServices = MpServices;
+        } else {
+            DbgPrint(DL_WARN, "%a(), MP services => %a, using BSP only\n", __func__, EFIStatusToStr(Status));
+        }
+    } else {
+        DbgPrint(DL_WARN, "%a(), MP services missing, using BSP only\n", __func__);
+    }
+#endif
+    gJobsInitialised = TRUE;
+
+    return EFI_SUCCESS;
+}
+
+EFI_STATUS ShutdownJobScheduler(VOID)
+{
+    DbgPrint(DL_INFO, "%a()\n", __func__);
+
+    if (!gJobsInitialised) {
+        DbgPrint(DL_ERROR, "%a(), job scheduler not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    if (gJobsRunning) {
+        DbgPrint(DL_ERROR, "%a(), called from a job => EFI_ACCESS_DENIED\n", __func__);
+        return EFI_ACCESS_DENIED;
+    }
+    // run anything still queued
+    WaitForJobs();
+    if (gJobEvent) {
+        gBS->CloseEvent(gJobEvent);
+        gJobEvent = NULL;
+    }
+    gMpServices = NULL;
+    gNumJobCores = 1;
+    gJobsInitialised = FALSE;
+
+    return EFI_SUCCESS;
+}
+
+UINTN NumJobCores(VOID)
+{
+    DbgPrint(DL_INFO, "%a()\n", __func__);
+
+    return gJobsInitialised ? gNumJobCores : 0;
+}
+
+EFI_STATUS SubmitJob(JOB_PROC Proc, VOID *Arg)
+{
+    DbgPrint(DL_INFO, "%a(Proc=0x%p, Arg=0x%p)\n", __func__, Proc, Arg);
+
+    if (!gJobsInitialised) {
+        DbgPrint(DL_ERROR, "%a(), job scheduler not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    if (!Proc) {
+        DbgPrint(DL_ERROR, "%a(), Proc=NULL => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    if (gJobsRunning) {
+        // the owner core may be popping from the queue, and a full queue would re-enter WaitForJobs()
+        DbgPrint(DL_ERROR, "%a(), called from a job => EFI_ACCESS_DENIED\n", __func__);
+        return EFI_ACCESS_DENIED;
+    }
+    // spread jobs round robin, cores that run out will steal the rest
+    JOB_QUEUE *Queue = &gJobQueue[gNextJobCore];
+    if (Queue->Bottom - Queue->Top >= JOB_QUEUE_SIZE) {
+        // queues full so run what we have
+        EFI_STATUS Status = WaitForJobs();
+        if (EFI_ERROR(Status)) {
+            return Status;
+        }
+    }
+    Queue->Jobs[Queue->Bottom & JOB_QUEUE_MASK].Proc = Proc;
+    Queue->Jobs[Queue->Bottom & JOB_QUEUE_MASK].Arg = Arg;
+    Queue->Bottom++;
+    gJobsPending++;
+    if (++gNextJobCore >= gNumJobCores) {
+        gNextJobCore = 0;
+    }
+
+    return EFI_SUCCESS;
+}
+
+EFI_STATUS WaitForJobs(VOID)
+{
+    DbgPrint(DL_INFO, "%a()\n", __func__);
+
+    if (!gJobsInitialised) {
+        DbgPrint(DL_ERROR, "%a(), job scheduler not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    if (gJobsRunning) {
+        DbgPrint(DL_ERROR, "%a(), called from a job => EFI_ACCESS_DENIED\n", __func__);
+        return EFI_ACCESS_DENIED;
+    }
+    if (gJobsPending == 0) {
+        return EFI_SUCCESS;
+    }
+    // set before APs start so jobs on them see it too
+    gJobsRunning = TRUE;
+    MemoryFence();
+    BOOLEAN ApsStarted = FALSE;
+    if (gMpServices && gNumJobCores > 1) {
+        EFI_STATUS Status = gMpServices->StartupAllAPs(gMpServices, job_worker, FALSE, gJobEvent, 0, NULL, NULL);
+        if (EFI_ERROR(Status)) {
+            DbgPrint(DL_WARN, "%a(), StartupAllAPs() => %a, using BSP only\n", __func__, EFIStatusToStr(Status));
+        } else {
+            ApsStarted = TRUE;
+        }
+    }
+    // BSP works too, then waits for APs to leave job_worker()
+    job_worker(NULL);
+    if (ApsStarted) {
+        while (gBS->CheckEvent(gJobEvent) == EFI_NOT_READY) {
+            CpuPause();
+        }
+    }
+    gJobsRunning = FALSE;
+    for (UINTN i = 0; i < gNumJobCores; i++) {
+        gJobQueue[i].Top = 0;
+        gJobQueue[i].Bottom = 0;
+    }
+    gNextJobCore = 0;
+
+    return EFI_SUCCESS;
+}
+
+EFI_STATUS GetJobCoreStats(UINTN Core, JOB_CORE_STATS *Stats)
+{
+    DbgPrint(DL_INFO, "%a(Core=%u, Stats=0x%p)\n", __func__, Core, Stats);
+
+    if (!gJobsInitialised) {
+        DbgPrint(DL_ERROR, "%a(), job scheduler not initialised => EFI_NOT_READY\n", __func__);
+        return EFI_NOT_READY;
+    }
+    if (!Stats || Core >= gNumJobCores) {
+        DbgPrint(DL_ERROR, "%a(), invalid parameter => EFI_INVALID_PARAMETER\n", __func__);
+        return EFI_INVALID_PARAMETER;
+    }
+    Stats->ProcessorNumber = gJobCoreProc[Core];
+    Stats->BusyTime = GetTimeInNanoSecond(gJobQueue[Core].BusyTicks);
+    Stats->IdleTime = GetTimeInNanoSecond(gJobQueue[Core].IdleTicks);
+    Stats->JobsRun = gJobQueue[Core].JobsRun;
+    Stats->JobsStolen = gJobQueue[Core].JobsStolen;
+
+    return EFI_SUCCESS;
+}
+
+VOID ResetJobStats(VOID)
+{
+    DbgPrint(DL_INFO, "%a()\n", __func__);
+
+    for (UINTN i = 0; i < MAX_JOB_CORES; i++) {
+        gJobQueue[i].BusyTicks = 0;
+        gJobQueue[i].IdleTicks = 0;
+        gJobQueue[i].JobsRun = 0;
+        gJobQueue[i].JobsStolen = 0;
+    }
+}
+
+/*
+ * pop_job() - owner takes most recently queued job from bottom of its queue
+ */
+STATIC BOOLEAN pop_job(JOB_QUEUE *Queue, JOB *Job)
+{
+    // interlocked so the Bottom store is visible before Top is read
+    UINT32 b = InterlockedDecrement(&Queue->Bottom);
+    UINT32 t = Queue->Top;
+    if ((INT32)(b - t) < 0) {
+        // empty
+        Queue->Bottom = t;
+        return FALSE;
+    }
+    *Job = Queue->Jobs[b & JOB_QUEUE_MASK];
+    if (b != t) {
+        return TRUE;
+    }
+    // last job so race any thieves for it
+    BOOLEAN Won = (InterlockedCompareExchange32(&Queue->Top, t, t + 1) == t);
+    Queue->Bottom = t + 1;
+    return Won;
+}
+
+/*
+ * steal_job() - take oldest job from top of another core's queue
+ */
+STATIC BOOLEAN steal_job(JOB_QUEUE *Queue, JOB *Job)
+{
+    UINT32 t = Queue->Top;
+    MemoryFence();
+    UINT32 b = Queue->Bottom;
+    if ((INT32)(b - t) <= 0) {
+        return FALSE;
+    }
+    *Job = Queue->Jobs[t & JOB_QUEUE_MASK];
+    return (InterlockedCompareExchange32(&Queue->Top, t, t + 1) == t);
+}
+
+/*
+ * job_worker() - runs on every core (AP procedure), no boot services allowed!
+ */
+STATIC VOID EFIAPI job_worker(VOID *Buffer)
+{
+    UINTN Core = 0;
+    if (Buffer == NULL && gMpServices) {
+        UINTN ProcNum;
+        gMpServices->WhoAmI(gMpServices, &ProcNum);
+        while (Core < gNumJobCores && gJobCoreProc[Core] != ProcNum) {
+            Core++;
+        }
+        if (Core >= gNumJobCores) {
+            return;     // not taking part
+        }
+    }
+    JOB_QUEUE *Queue = &gJobQueue[Core];
+    UINT64 Start = GetPerformanceCounter();
+    while (gJobsPending) {
+        JOB Job;
+        BOOLEAN Found = pop_job(Queue, &Job);
+        for (UINTN i = 1; !Found && i < gNumJobCores; i++) {
+            UINTN Victim = Core + i;
+            if (Victim >= gNumJobCores) {
+                Victim -= gNumJobCores;
+            }
+            if (steal_job(&gJobQueue[Victim], &Job)) {
+                Found = TRUE;
+                Queue->JobsStolen++;
+            }
+        }
+        if (!Found) {
+            CpuPause();
+            continue;
+        }
+        UINT64 Now = GetPerformanceCounter();
+        Queue->IdleTicks += Now - Start;
+        Job.Proc(Job.Arg);
+        Start = GetPerformanceCounter();
+        Queue->BusyTicks += Start - Now;
+        Queue->JobsRun++;
+        InterlockedDecrement(&gJobsPending);
+    }
+    Queue->IdleTicks += GetPerformanceCounter() - Start;
+}
+
+// rows filled per job are chosen so that each core gets several bands to balance
+#define MAX_FILL_JOBS       128
+#define MIN_FILL_ROWS       8
+#define MIN_PARALLEL_FILL   (256 * 256)
+
+typedef struct {
+    UINT32  *Ptr;
+    UINT32  Width;
+    UINT32  Height;
+    UINT32  PixPerScnLn;
+    UINT32  Colour;
+} FILL_JOB;
+
+STATIC FILL_JOB gFillJobs[MAX_FILL_JOBS];
+
+STATIC VOID EFIAPI fill_job(VOID *Arg)
+{
+    FILL_JOB *Fill = (FILL_JOB *)Arg;
+    UINT32 *ptr = Fill->Ptr;
+    UINT32 height = Fill->Height;
+    while (height--) {
+        SetMem32(ptr, Fill->Width * sizeof(UINT32), Fill->Colour);
+        ptr += Fill->PixPerScnLn;
+    }
+}
+
+/*
+ * parallel_fill() - return TRUE if fill was done by job scheduler
+ */
+STATIC BOOLEAN parallel_fill(UINT32 *ptr, UINT32 width, UINT32 height, UINT32 PixPerScnLn, UINT32 colour)
+{
+    DbgPrint(DL_INFO, "%a(ptr=0x%p, width=%u, height=%u, PixPerScnLn=%u, colour=0x%08X)\n", __func__, ptr, width, height, PixPerScnLn, colour);
+
+#if JOB_SCHEDULER
+    // jobs can draw using a context so never nest a parallel fill inside one, and
+    // leave the scheduler alone while the caller has jobs of its own queued
+    if (!gJobsInitialised || gJobsRunning || gJobsPending || gNumJobCores < 2 || width * height < MIN_PARALLEL_FILL) {
+        return FALSE;
+    }
+    UINT32 rows = height / (gNumJobCores * 4);
+    if (rows < MIN_FILL_ROWS) {
+        rows = MIN_FILL_ROWS;
+    }
+    if (rows * MAX_FILL_JOBS < height) {
+        rows = (height + MAX_FILL_JOBS - 1) / MAX_FILL_JOBS;
+    }
+    UINTN n = 0;
+    while (height) {
+        FILL_JOB *Fill = &gFillJobs[n++];
+        Fill->Ptr = ptr;
+        Fill->Width = width;
+        Fill->Height = (height < rows) ? height : rows;
+        Fill->PixPerScnLn = PixPerScnLn;
+        Fill->Colour = colour;
+        SubmitJob(fill_job, Fill);
+        ptr += Fill->Height * PixPerScnLn;
+        height -= Fill->Height;
+    }
+    WaitForJobs();
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
 //-------------------------------------------------------------------------
 // DEBUG
 //-------------------------------------------------------------------------
@@ -1914,10 +8085,10 @@ EFI_STATUS ClearTextBox(TEXT_BOX *TxtBox)
 // check to see if ptr does actual map to supplied co-ordinates!
 STATIC VOID CheckPtr(UINT32 *ptr, INT32 x, INT32 y)
 {
-    UINT32 *ptr2 = gCurrRenBuf->PixelData + x + (y * gCurrRenBuf->PixPerScnLn);
+    UINT32 *ptr2 = gCurrCtx.RenBuf->PixelData + x + (y * gCurrCtx.RenBuf->PixPerScnLn);
     if (ptr != ptr2) {
-        INT32 y2 = (ptr - gCurrRenBuf->PixelData) / gCurrRenBuf->PixPerScnLn;
-        INT32 x2 = (ptr - gCurrRenBuf->PixelData) % gCurrRenBuf->PixPerScnLn;
+        INT32 y2 = (ptr - gCurrCtx.RenBuf->PixelData) / gCurrCtx.RenBuf->PixPerScnLn;
+        INT32 x2 = (ptr - gCurrCtx.RenBuf->PixelData) % gCurrCtx.RenBuf->PixPerScnLn;
         Print(L"Mismatch: Passed(%d, %d) Actual(%d, %d)\n", x, y, x2, y2);
     }
 }
@@ -68,6 +68,7 @@ typedef struct {
     INT32       ClipX1;
     INT32       ClipY1;
     UINT32      *PixelData;
+    UINT16      *DepthData;     // optional depth buffer, HorRes per row
     TEXT_CONFIG TxtCfg;
 } RENDER_BUFFER;
 
@@ -77,6 +78,189 @@ typedef struct {
     TEXT_CONFIG     TxtCfg;
 } TEXT_BOX;
 
+// Graphics context, holds its own target, clip window and text config so
+// several can be drawn to at the same time (e.g. from jobs on different cores).
+// Screen contexts must be recreated after a graphics mode change.
+typedef struct {
+    UINT32          Sig;
+    RENDER_BUFFER   *RenBuf;
+    BOOLEAN         RenderToScreen;
+    INT32           ClipX0;
+    INT32           ClipY0;
+    INT32           ClipX1;
+    INT32           ClipY1;
+    TEXT_CONFIG     TxtCfg;
+} GFX_CONTEXT;
+
+// Point
+typedef struct {
+    INT32       X;
+    INT32       Y;
+} POINT;
+
+// Rectangle, corners inclusive and in either order
+typedef struct {
+    INT32       X0;
+    INT32       Y0;
+    INT32       X1;
+    INT32       Y1;
+} RECT;
+
+// Textured vertex, U/V are texture coords in 16.16 fixed point texels
+// (texel [i,j] spans i..i+1, j..j+1)
+typedef struct {
+    INT32       X;
+    INT32       Y;
+    INT32       U;
+    INT32       V;
+} TEX_VERTEX;
+
+// 3D vertex, coords in 16.16 fixed point
+typedef struct {
+    INT32       X;
+    INT32       Y;
+    INT32       Z;
+} VERTEX3;
+
+// 4x4 matrix in 16.16 fixed point, M[Row][Col] applied to column vectors
+typedef struct {
+    INT32       M[4][4];
+} MATRIX4;
+
+// Heatmap cell formats
+typedef enum {
+    HEATMAP_U8=0,   // UINT8 cells
+    HEATMAP_U16,    // UINT16 cells
+    NUM_HEATMAP_FORMATS
+} HEATMAP_FORMAT;
+
+// Polygon fill rules
+typedef enum {
+    FILL_EVEN_ODD=0,    // inside if a ray crosses an odd number of edges
+    FILL_NON_ZERO,      // inside if edge winding does not sum to zero
+    NUM_FILL_RULES
+} FILL_RULE;
+
+// Thick line end styles
+typedef enum {
+    LINE_CAP_BUTT=0,    // square at the end points
+    LINE_CAP_SQUARE,    // square, half the width past the end points
+    LINE_CAP_ROUND,     // semicircle around the end points
+    NUM_LINE_CAPS
+} LINE_CAP;
+
+// Thick line corner styles
+typedef enum {
+    LINE_JOIN_MITER=0,  // outer edges extended to meet, bevelled when the corner is too sharp
+    LINE_JOIN_BEVEL,    // outer corners joined straight across
+    LINE_JOIN_ROUND,    // outer corners rounded
+    NUM_LINE_JOINS
+} LINE_JOIN;
+
+// Pen for thick and dashed lines, Dashes are lengths in pixels alternately on and off
+typedef struct {
+    UINT32          Width;
+    LINE_CAP        Cap;
+    LINE_JOIN       Join;
+    CONST UINT32    *Dashes;        // NULL for a solid line
+    UINTN           NumDashes;
+    UINT32          DashOffset;     // distance into the pattern at the first point
+} PEN;
+
+// Gradient kinds
+typedef enum {
+    GRADIENT_LINEAR=0,  // C0 at (X0, Y0) to C1 at (X1, Y1), constant across the line between them
+    GRADIENT_RADIAL,    // C0 at centre (X0, Y0) to C1 at Radius
+    NUM_GRADIENT_TYPES
+} GRADIENT_TYPE;
+
+// Two colour gradient in pixel coordinates, colours hold past the ends
+typedef struct {
+    GRADIENT_TYPE   Type;
+    INT32           X0;
+    INT32           Y0;
+    INT32           X1;         // linear only
+    INT32           Y1;
+    UINT32          Radius;     // radial only
+    UINT32          C0;
+    UINT32          C1;
+    BOOLEAN         Dither;     // 4x4 ordered dither between colour steps
+} GRADIENT;
+
+// Brush kinds for pattern fills
+typedef enum {
+    BRUSH_PATTERN=0,    // 8x8 mono pattern, set bits FgColour and clear bits BgColour
+    BRUSH_TILE,         // render buffer repeated
+    NUM_BRUSH_TYPES
+} BRUSH_TYPE;
+
+// Fill brush, the pattern or tile's top left is at (OriginX, OriginY) and repeats from there
+typedef struct {
+    BRUSH_TYPE          Type;
+    UINT8               Pattern[8];     // rows top to bottom, bit 7 is the left pixel
+    UINT32              FgColour;
+    UINT32              BgColour;
+    BOOLEAN             Transparent;    // clear bits leave the pixel as it is
+    CONST RENDER_BUFFER *Tile;
+    INT32               OriginX;
+    INT32               OriginY;
+} BRUSH;
+
+// Scrolling strip chart, samples are min/max decimated into pixel columns
+typedef struct {
+    INT32       X0;
+    INT32       Y0;
+    INT32       X1;
+    INT32       Y1;
+    INT32       MinVal;
+    INT32       MaxVal;
+    UINT32      SamplesPerColumn;
+    INT32       ScrollStep;     // columns scrolled when chart is full
+    UINT32      FgColour;
+    UINT32      BgColour;
+    INT32       CurrX;          // column currently being built
+    UINT32      ColSamples;
+    INT32       ColMin;
+    INT32       ColMax;
+    INT32       LastVal;        // joins column to previous one
+    BOOLEAN     HaveLastVal;
+} STRIP_CHART;
+
+// Vector path, curves are flattened into line contours as the path is built
+// Coords are 16.16 with pixel [x,y] covering x..x+1, y..y+1, and within +/-8192 pixels
+typedef struct {
+    UINT32      Sig;
+    POINT       *Points;
+    UINT32      *Contours;      // end of each contour in Points (bit 31 set once closed)
+    UINTN       NumPoints;
+    UINTN       MaxPoints;
+    UINTN       NumContours;
+    UINTN       MaxContours;
+} GFX_PATH;
+
+// Raw surface, base pointer/stride/clip window of a render target for
+// drawing directly in tight loops. SURFACE_xxx macros do NO clipping.
+typedef struct {
+    UINT32      *PixelData;
+    INT32       PixPerScnLn;
+    INT32       ClipX0;
+    INT32       ClipY0;
+    INT32       ClipX1;
+    INT32       ClipY1;
+} GFX_SURFACE;
+
+// Job procedure, may run on an AP so must not call boot services or the job scheduler functions
+typedef VOID (EFIAPI *JOB_PROC)(VOID *Arg);
+
+// Per-core job scheduler statistics
+typedef struct {
+    UINTN       ProcessorNumber;
+    UINT64      BusyTime;       // ns running jobs
+    UINT64      IdleTime;       // ns looking for jobs
+    UINT32      JobsRun;
+    UINT32      JobsStolen;     // jobs taken from other cores
+} JOB_CORE_STATS;
+
 
 // Functions to initialise/query frame buffer
 EFI_STATUS InitGraphics(VOID);
@@ -96,6 +280,11 @@ EFI_STATUS SetRenderBuffer(RENDER_BUFFER *RenBuf);
 EFI_STATUS SetScreenRender(VOID);
 EFI_STATUS DisplayRenderBuffer(RENDER_BUFFER *RenBuf, INT32 x, INT32 y);
 
+// Depth buffer functions (RenBuf NULL == Screen)
+EFI_STATUS CreateDepthBuffer(RENDER_BUFFER *RenBuf);
+EFI_STATUS ClearDepthBuffer(RENDER_BUFFER *RenBuf);
+EFI_STATUS DestroyDepthBuffer(RENDER_BUFFER *RenBuf);
+
 // Functions that operate on current render target
 UINT32 GetHorRes(VOID);
 UINT32 GetVerRes(VOID);
@@ -114,12 +303,178 @@ VOID DrawHLine(INT32 x, INT32 y, INT32 width, UINT32 colour);
 VOID DrawHLine2(INT32 x0, INT32 x1, INT32 y, UINT32 colour);
 VOID DrawVLine(INT32 x, INT32 y, INT32 height, UINT32 colour);
 VOID DrawLine(INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour);
+EFI_STATUS DrawPolyline(CONST POINT *Points, UINTN Count, UINT32 colour);
+EFI_STATUS DrawLines(CONST POINT *Points, UINTN Count, UINT32 colour);
+VOID DrawLineAA(INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour);
+EFI_STATUS DrawThickLine(INT32 x0, INT32 y0, INT32 x1, INT32 y1, CONST PEN *Pen, UINT32 colour);
+EFI_STATUS DrawThickPolyline(CONST POINT *Points, UINTN Count, CONST PEN *Pen, UINT32 colour);
+// Bezier curves from Count = 3 (quadratic) or 4 (cubic) control points
+EFI_STATUS DrawBezier(CONST POINT *Points, UINTN Count, UINT32 colour);
+EFI_STATUS DrawBezierAA(CONST POINT *Points, UINTN Count, UINT32 colour);
 VOID DrawTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 colour);
 VOID DrawRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour);
 VOID DrawFillTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 colour);
+VOID DrawMeshTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 colour);
+VOID DrawShadedTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 c0, UINT32 c1, UINT32 c2);
 VOID DrawFillRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour);
+UINTN DrawFillRects(CONST RECT *Rects, CONST UINT32 *Colours, UINTN Count);
 VOID DrawCircle(INT32 xc, INT32 yc, INT32 r, UINT32 colour);
 VOID DrawFillCircle(INT32 xc, INT32 yc, INT32 r, UINT32 colour);
+EFI_STATUS DrawEllipse(INT32 xc, INT32 yc, INT32 rx, INT32 ry, UINT32 colour);
+EFI_STATUS DrawFillEllipse(INT32 xc, INT32 yc, INT32 rx, INT32 ry, UINT32 colour);
+// Arcs and pies run clockwise from StartAngle to EndAngle, tenths of a degree from +x
+EFI_STATUS DrawArc(INT32 xc, INT32 yc, INT32 rx, INT32 ry, INT32 StartAngle, INT32 EndAngle, UINT32 colour);
+EFI_STATUS DrawPie(INT32 xc, INT32 yc, INT32 rx, INT32 ry, INT32 StartAngle, INT32 EndAngle, UINT32 colour);
+EFI_STATUS DrawFillPie(INT32 xc, INT32 yc, INT32 rx, INT32 ry, INT32 StartAngle, INT32 EndAngle, UINT32 colour);
+EFI_STATUS DrawRoundedRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 r, UINT32 colour);
+EFI_STATUS DrawFillRoundedRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 r, UINT32 colour);
+UINTN DrawPoints(CONST POINT *Points, UINTN Count, UINT32 colour);
+VOID DrawPlot(CONST INT32 *Samples, UINTN Count, INT32 MinVal, INT32 MaxVal, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour);
+UINTN DrawColourPoints(CONST POINT *Points, CONST UINT32 *Colours, UINTN Count);
+EFI_STATUS DrawHeatmap(CONST VOID *Cells, HEATMAP_FORMAT Format, UINT32 Cols, UINT32 Rows, UINT32 Pitch, CONST UINT32 *Lut, UINT32 LutSize, INT32 x0, INT32 y0, INT32 x1, INT32 y1);
+EFI_STATUS DrawFillPolygon(CONST POINT *Points, UINTN Count, FILL_RULE Rule, UINT32 colour);
+EFI_STATUS DrawFillPolyPolygon(CONST POINT *Points, CONST UINTN *Counts, UINTN NumContours, FILL_RULE Rule, UINT32 colour);
+// Fills the 4-connected region of the colour at (x, y) within the clip window, EFI_OUT_OF_RESOURCES leaves it part filled
+EFI_STATUS FloodFill(INT32 x, INT32 y, UINT32 colour);
+EFI_STATUS DrawGradientRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, CONST GRADIENT *Gradient);
+EFI_STATUS DrawGradientSpan(INT32 x0, INT32 x1, INT32 y, CONST GRADIENT *Gradient);
+EFI_STATUS DrawBrushRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, CONST BRUSH *Brush);
+EFI_STATUS DrawBrushPolygon(CONST POINT *Points, UINTN Count, FILL_RULE Rule, CONST BRUSH *Brush);
+EFI_STATUS DrawBrushCircle(INT32 xc, INT32 yc, INT32 r, CONST BRUSH *Brush);
+
+// Graphics context functions, same as above but drawing via a context
+EFI_STATUS CreateContext(GFX_CONTEXT *Ctx, RENDER_BUFFER *RenBuf);
+UINT32 CtxGetHorRes(GFX_CONTEXT *Ctx);
+UINT32 CtxGetVerRes(GFX_CONTEXT *Ctx);
+VOID CtxResetClipping(GFX_CONTEXT *Ctx);
+VOID CtxSetClipping(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1);
+BOOLEAN CtxClipped(GFX_CONTEXT *Ctx);
+VOID CtxClearScreen(GFX_CONTEXT *Ctx, UINT32 colour);
+VOID CtxClearClipWindow(GFX_CONTEXT *Ctx, UINT32 colour);
+VOID CtxPutPixel(GFX_CONTEXT *Ctx, INT32 x, INT32 y, UINT32 colour);
+UINT32 CtxGetPixel(GFX_CONTEXT *Ctx, INT32 x, INT32 y);
+VOID CtxDrawHLine(GFX_CONTEXT *Ctx, INT32 x, INT32 y, INT32 width, UINT32 colour);
+VOID CtxDrawHLine2(GFX_CONTEXT *Ctx, INT32 x0, INT32 x1, INT32 y, UINT32 colour);
+VOID CtxDrawVLine(GFX_CONTEXT *Ctx, INT32 x, INT32 y, INT32 height, UINT32 colour);
+VOID CtxDrawLine(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour);
+EFI_STATUS CtxDrawPolyline(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, UINT32 colour);
+EFI_STATUS CtxDrawLines(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, UINT32 colour);
+VOID CtxDrawLineAA(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour);
+EFI_STATUS CtxDrawThickLine(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, CONST PEN *Pen, UINT32 colour);
+EFI_STATUS CtxDrawThickPolyline(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, CONST PEN *Pen, UINT32 colour);
+EFI_STATUS CtxDrawBezier(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, UINT32 colour);
+EFI_STATUS CtxDrawBezierAA(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, UINT32 colour);
+VOID CtxDrawTriangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 colour);
+VOID CtxDrawRectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour);
+VOID CtxDrawFillTriangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 colour);
+VOID CtxDrawMeshTriangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 colour);
+VOID CtxDrawShadedTriangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 c0, UINT32 c1, UINT32 c2);
+VOID CtxDrawFillRectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour);
+UINTN CtxDrawFillRects(GFX_CONTEXT *Ctx, CONST RECT *Rects, CONST UINT32 *Colours, UINTN Count);
+VOID CtxDrawCircle(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 r, UINT32 colour);
+VOID CtxDrawFillCircle(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 r, UINT32 colour);
+EFI_STATUS CtxDrawEllipse(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 rx, INT32 ry, UINT32 colour);
+EFI_STATUS CtxDrawFillEllipse(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 rx, INT32 ry, UINT32 colour);
+EFI_STATUS CtxDrawArc(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 rx, INT32 ry, INT32 StartAngle, INT32 EndAngle, UINT32 colour);
+EFI_STATUS CtxDrawPie(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 rx, INT32 ry, INT32 StartAngle, INT32 EndAngle, UINT32 colour);
+EFI_STATUS CtxDrawFillPie(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 rx, INT32 ry, INT32 StartAngle, INT32 EndAngle, UINT32 colour);
+EFI_STATUS CtxDrawRoundedRectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 r, UINT32 colour);
+EFI_STATUS CtxDrawFillRoundedRectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 r, UINT32 colour);
+UINTN CtxDrawPoints(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, UINT32 colour);
+VOID CtxDrawPlot(GFX_CONTEXT *Ctx, CONST INT32 *Samples, UINTN Count, INT32 MinVal, INT32 MaxVal, INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 colour);
+UINTN CtxDrawColourPoints(GFX_CONTEXT *Ctx, CONST POINT *Points, CONST UINT32 *Colours, UINTN Count);
+EFI_STATUS CtxDrawHeatmap(GFX_CONTEXT *Ctx, CONST VOID *Cells, HEATMAP_FORMAT Format, UINT32 Cols, UINT32 Rows, UINT32 Pitch, CONST UINT32 *Lut, UINT32 LutSize, INT32 x0, INT32 y0, INT32 x1, INT32 y1);
+EFI_STATUS CtxDrawFillPolygon(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, FILL_RULE Rule, UINT32 colour);
+EFI_STATUS CtxDrawFillPolyPolygon(GFX_CONTEXT *Ctx, CONST POINT *Points, CONST UINTN *Counts, UINTN NumContours, FILL_RULE Rule, UINT32 colour);
+EFI_STATUS CtxFloodFill(GFX_CONTEXT *Ctx, INT32 x, INT32 y, UINT32 colour);
+EFI_STATUS CtxDrawGradientRectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, CONST GRADIENT *Gradient);
+EFI_STATUS CtxDrawGradientSpan(GFX_CONTEXT *Ctx, INT32 x0, INT32 x1, INT32 y, CONST GRADIENT *Gradient);
+EFI_STATUS CtxDrawBrushRectangle(GFX_CONTEXT *Ctx, INT32 x0, INT32 y0, INT32 x1, INT32 y1, CONST BRUSH *Brush);
+EFI_STATUS CtxDrawBrushPolygon(GFX_CONTEXT *Ctx, CONST POINT *Points, UINTN Count, FILL_RULE Rule, CONST BRUSH *Brush);
+EFI_STATUS CtxDrawBrushCircle(GFX_CONTEXT *Ctx, INT32 xc, INT32 yc, INT32 r, CONST BRUSH *Brush);
+EFI_STATUS EFIAPI CtxGPutString(GFX_CONTEXT *Ctx, INT32 x, INT32 y, UINT32 FgColour, UINT32 BgColour, BOOLEAN BgColourEnabled, FONT Font, CHAR16 *sFormat, ...);
+UINTN EFIAPI CtxGPrint(GFX_CONTEXT *Ctx, CHAR16 *sFormat, ...);
+VOID CtxEnableTextBackground(GFX_CONTEXT *Ctx, BOOLEAN State);
+VOID CtxSetTextForeground(GFX_CONTEXT *Ctx, UINT32 colour);
+VOID CtxSetTextBackground(GFX_CONTEXT *Ctx, UINT32 colour);
+VOID CtxSetFont(GFX_CONTEXT *Ctx, FONT font);
+
+// Raw surface functions
+EFI_STATUS GetSurface(GFX_SURFACE *Surface);
+EFI_STATUS CtxGetSurface(GFX_CONTEXT *Ctx, GFX_SURFACE *Surface);
+UINT32 *SurfaceCheckedPtr(CONST GFX_SURFACE *Surface, INT32 x, INT32 y);
+
+// When set to 1 every raw surface access ASSERTs it is inside the clip window
+#ifndef GFX_SURFACE_CHECKS
+#define GFX_SURFACE_CHECKS 0
+#endif
+
+// Raw surface pixel access
+#define SURFACE_IN_CLIP(s, x, y) ((x) >= (s)->ClipX0 && (x) <= (s)->ClipX1 && (y) >= (s)->ClipY0 && (y) <= (s)->ClipY1)
+#if GFX_SURFACE_CHECKS
+#define SURFACE_PIXEL_PTR(s, x, y) SurfaceCheckedPtr((s), (x), (y))
+#else
+#define SURFACE_PIXEL_PTR(s, x, y) ((s)->PixelData + (x) + ((y) * (s)->PixPerScnLn))
+#endif
+#define SURFACE_PUT_PIXEL(s, x, y, colour) (*SURFACE_PIXEL_PTR(s, x, y) = (colour))
+#define SURFACE_GET_PIXEL(s, x, y) (*SURFACE_PIXEL_PTR(s, x, y))
+
+// Strip chart functions (chart area is not cleared by InitStripChart)
+EFI_STATUS InitStripChart(STRIP_CHART *Chart, INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 MinVal, INT32 MaxVal, UINT32 SamplesPerColumn, UINT32 FgColour, UINT32 BgColour);
+UINTN AppendStripChart(STRIP_CHART *Chart, CONST INT32 *Samples, UINTN Count);
+UINTN CtxAppendStripChart(GFX_CONTEXT *Ctx, STRIP_CHART *Chart, CONST INT32 *Samples, UINTN Count);
+
+// Vector path functions, anti-aliased, Width is 16.16
+EFI_STATUS CreatePath(GFX_PATH *Path);
+EFI_STATUS ResetPath(GFX_PATH *Path);
+EFI_STATUS DestroyPath(GFX_PATH *Path);
+EFI_STATUS PathMoveTo(GFX_PATH *Path, INT32 x, INT32 y);
+EFI_STATUS PathLineTo(GFX_PATH *Path, INT32 x, INT32 y);
+EFI_STATUS PathQuadTo(GFX_PATH *Path, INT32 cx, INT32 cy, INT32 x, INT32 y);
+EFI_STATUS PathCubicTo(GFX_PATH *Path, INT32 c1x, INT32 c1y, INT32 c2x, INT32 c2y, INT32 x, INT32 y);
+EFI_STATUS PathClose(GFX_PATH *Path);
+EFI_STATUS DrawFillPath(CONST GFX_PATH *Path, FILL_RULE Rule, UINT32 colour);
+EFI_STATUS DrawStrokePath(CONST GFX_PATH *Path, INT32 Width, UINT32 colour);
+EFI_STATUS DrawGradientPath(CONST GFX_PATH *Path, FILL_RULE Rule, CONST GRADIENT *Gradient);
+EFI_STATUS CtxDrawFillPath(GFX_CONTEXT *Ctx, CONST GFX_PATH *Path, FILL_RULE Rule, UINT32 colour);
+EFI_STATUS CtxDrawStrokePath(GFX_CONTEXT *Ctx, CONST GFX_PATH *Path, INT32 Width, UINT32 colour);
+EFI_STATUS CtxDrawGradientPath(GFX_CONTEXT *Ctx, CONST GFX_PATH *Path, FILL_RULE Rule, CONST GRADIENT *Gradient);
+
+// Texture mapping functions, textures and sprites are render buffers
+// Angle is clockwise in tenths of a degree, Scale and Matrix {a, b, c, d} are 16.16
+EFI_STATUS DrawTexturedTriangle(RENDER_BUFFER *Texture, CONST TEX_VERTEX *v0, CONST TEX_VERTEX *v1, CONST TEX_VERTEX *v2, UINT32 Flags, UINT32 ColourKey);
+EFI_STATUS DrawTexturedQuad(RENDER_BUFFER *Texture, CONST TEX_VERTEX *Vertex, UINT32 Flags, UINT32 ColourKey);
+EFI_STATUS DrawSpriteAffine(RENDER_BUFFER *Sprite, INT32 px, INT32 py, INT32 x, INT32 y, CONST INT32 *Matrix, UINT32 Flags, UINT32 ColourKey);
+EFI_STATUS DrawRotatedSprite(RENDER_BUFFER *Sprite, INT32 px, INT32 py, INT32 x, INT32 y, INT32 Angle, UINT32 Scale, UINT32 Flags, UINT32 ColourKey);
+EFI_STATUS CtxDrawTexturedTriangle(GFX_CONTEXT *Ctx, RENDER_BUFFER *Texture, CONST TEX_VERTEX *v0, CONST TEX_VERTEX *v1, CONST TEX_VERTEX *v2, UINT32 Flags, UINT32 ColourKey);
+EFI_STATUS CtxDrawTexturedQuad(GFX_CONTEXT *Ctx, RENDER_BUFFER *Texture, CONST TEX_VERTEX *Vertex, UINT32 Flags, UINT32 ColourKey);
+EFI_STATUS CtxDrawSpriteAffine(GFX_CONTEXT *Ctx, RENDER_BUFFER *Sprite, INT32 px, INT32 py, INT32 x, INT32 y, CONST INT32 *Matrix, UINT32 Flags, UINT32 ColourKey);
+EFI_STATUS CtxDrawRotatedSprite(GFX_CONTEXT *Ctx, RENDER_BUFFER *Sprite, INT32 px, INT32 py, INT32 x, INT32 y, INT32 Angle, UINT32 Scale, UINT32 Flags, UINT32 ColourKey);
+
+// Texture mapping flags
+#define TEX_NEAREST     0x00    // nearest texel
+#define TEX_BILINEAR    0x01    // bilinear filtering
+#define TEX_COLOUR_KEY  0x02    // texels matching ColourKey are not drawn
+#define TEX_ALPHA       0x04    // blend using texel bits 31:24 as alpha
+
+// Matrix functions, Angle is in tenths of a degree, other values are 16.16
+VOID MatrixIdentity(MATRIX4 *M);
+VOID MatrixMultiply(MATRIX4 *Result, CONST MATRIX4 *A, CONST MATRIX4 *B);
+VOID MatrixTranslation(MATRIX4 *M, INT32 x, INT32 y, INT32 z);
+VOID MatrixScaling(MATRIX4 *M, INT32 x, INT32 y, INT32 z);
+VOID MatrixRotationX(MATRIX4 *M, INT32 Angle);
+VOID MatrixRotationY(MATRIX4 *M, INT32 Angle);
+VOID MatrixRotationZ(MATRIX4 *M, INT32 Angle);
+EFI_STATUS MatrixPerspective(MATRIX4 *M, INT32 Fov, INT32 Aspect, INT32 Near, INT32 Far);
+
+// 3D mesh functions, Indices holds 3 per triangle, Colours 1 per triangle
+// Transform maps vertices to clip space, NDC -1..1 covers the clip window
+EFI_STATUS DrawMesh(CONST MATRIX4 *Transform, CONST VERTEX3 *Vertices, UINTN NumVertices, CONST UINT32 *Indices, UINTN NumTriangles, CONST UINT32 *Colours, UINT32 Flags);
+EFI_STATUS CtxDrawMesh(GFX_CONTEXT *Ctx, CONST MATRIX4 *Transform, CONST VERTEX3 *Vertices, UINTN NumVertices, CONST UINT32 *Indices, UINTN NumTriangles, CONST UINT32 *Colours, UINT32 Flags);
+
+// 3D mesh flags
+#define MESH_CULL_BACK  0x01    // skip triangles wound clockwise in NDC
+#define MESH_DEPTH_TEST 0x02    // depth test and write against render buffer depth buffer
 
 // Font info functions
 CONST CHAR8 *GetFontName(FONT Font);
@@ -143,6 +498,15 @@ VOID SetTextBoxForeground(TEXT_BOX *TxtBox, UINT32 colour);
 VOID SetTextBoxBackground(TEXT_BOX *TxtBox, UINT32 colour);
 VOID SetTextBoxFont(TEXT_BOX *TxtBox, FONT Font);
 
+// Job scheduler functions
+EFI_STATUS InitJobScheduler(UINTN MaxCores);
+EFI_STATUS ShutdownJobScheduler(VOID);
+UINTN NumJobCores(VOID);
+EFI_STATUS SubmitJob(JOB_PROC Proc, VOID *Arg);
+EFI_STATUS WaitForJobs(VOID);
+EFI_STATUS GetJobCoreStats(UINTN Core, JOB_CORE_STATS *Stats);
+VOID ResetJobStats(VOID);
+
 // Miscellaneous functions
 VOID PrintFontInfo(CONST UINT8 *FontData);
 